@@ -61,6 +61,10 @@ DllExport void PASCAL UndoAllWin(void);
 DllExport int PASCAL CommReadRawByte(PComVar cv, LPBYTE b);
 DllExport int PASCAL CommRead1Byte(PComVar cv, LPBYTE b);
 DllExport void PASCAL CommInsert1Byte(PComVar cv, BYTE b);
+DllExport int PASCAL CommReadSpan(PComVar cv, const BYTE **ptr);
+DllExport void PASCAL CommReadSpanCommit(PComVar cv, int len);
+DllExport int PASCAL CommInBuffWriteSpan(PComVar cv, BYTE **ptr);
+DllExport void PASCAL CommInBuffWriteCommit(PComVar cv, int len);
 DllExport int PASCAL CommRawOut(PComVar cv, PCHAR B, int C);
 DllExport int PASCAL CommBinaryOut(PComVar cv, PCHAR B, int C);
 DllExport int PASCAL CommBinaryBuffOut(PComVar cv, PCHAR B, int C);
@@ -92,6 +92,9 @@
 #define CmdSendBinary       'b'
 #define CmdSendCompatString 'c'	// ]̕Mƌ݊, StringBinaryKv
 #define CmdGetTTPos         'd'
+#define CmdSftpSend         'e'
+#define CmdSftpRcv          'f'
+#define CmdSetSftpOpt       'g'
 
 #define LogOptBinary        1
 #define LogOptAppend        2
@@ -43,6 +43,7 @@
 #define IdPrnProcTimer       9
 #define IdCancelConnectTimer 10  // add (2007.1.10 yutaka)
 #define IdPasteDelayTimer    11
+#define IdSftpTimer          12
 
   /* Window Id */
 #define IdVT  1
@@ -620,6 +621,7 @@ struct tttset {
 	WORD AutoComPortReconnectDelayIllegal;		// (ms)
 	WORD AutoComPortReconnectRetryInterval;		// (ms)
 	WORD AutoComPortReconnectRetryCount;		// 0~
+	int RecvBufferSize;
 
 	// Experimental
 	BYTE ExperimentalTreePropertySheetEnable;
@@ -791,9 +793,12 @@ typedef struct tttset TTTSet, *PTTSet;
 
 #define InBuffSize  1024
 #define OutBuffSize (1024*16)
+#define InBuffSizeDefault	(1024*64)	// Mobt@(TComVar.InBuff)̃ftHgTCY
+#define InBuffSizeMax		(1024*1024*16)
+#define InBuffInsertMargin	16			// CommInsert1Byte() pɋ󂯂Ă̈
 
 typedef struct {
-	BYTE InBuff[InBuffSize];
+	BYTE InBuffFixed[InBuffSize];	// InBuff mۂłȂƂɎgp
 	int InBuffCount, InPtr;
 	BYTE OutBuff[OutBuffSize];
 	int OutBuffCount, OutPtr;
@@ -886,6 +891,12 @@ typedef struct {
 
 	void *StateSend;
 	void *StateEcho;
+
+	/* Mobt@(Oobt@)
+	 *	InPtr  InBuffCount byte ǃf[^
+	 *	InBuffCapacity 𒴂Ɛ擪ɖ߂ */
+	BYTE *InBuff;
+	int InBuffCapacity;
 } TComVar;
 typedef TComVar *PComVar;
 
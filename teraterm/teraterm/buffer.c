@@ -53,31 +53,39 @@
 #define	ENABLE_CELL_INDEX	0
 
 // obt@̔p1̏
+//	XN[obt@ (s x ) mۂ̂ŏĂ
+//	ȂǁAقƂǂ̃ZŎgpȂ CombTable[] ɒu
 typedef struct {
 	char32_t u32;
-	char32_t u32_last;
 	char WidthProperty;				// 'W' or 'F' or 'H' or 'A' or 'n'(Narrow) or 'N'(Neutual) (̑)
 	char cell;			// cell 1/2/3+=p,Sp,3ȏ
 						// 2ȏ̂ƂǍ̕paddingcell-1
 	char Padding;					// TRUE = Sp̎̋lߕ or s̋lߕ
-	char Emoji;						// TRUE = G
-	unsigned char CombinationCharCount16;	// character count
-	unsigned char CombinationCharSize16;		// buffer size
-	unsigned char CombinationCharCount32;
-	unsigned char CombinationCharSize32;
-	wchar_t *pCombinationChars16;
-	char32_t *pCombinationChars32;
-	wchar_t	wc2[2];
+	unsigned char Emoji : 1;		// TRUE = G
+	unsigned char CodePageIdx : 7;	// 񂾂Ƃ CodePage, CodePageTable[]  index
 	unsigned char fg;
 	unsigned char bg;
 	unsigned char attr;
 	unsigned char attr2;
-	unsigned short ansi_char;
+	DWORD comb;						// CombTable[]  index, 0=Ȃ
 #if ENABLE_CELL_INDEX
 	int idx;	// Zʂԍ
 #endif
 } buff_char_t;
 
+// ̏
+typedef struct {
+	char32_t u32_last;						// ŌɌ
+	unsigned char CombinationCharCount16;	// character count
+	unsigned char CombinationCharSize16;		// buffer size
+	unsigned char CombinationCharCount32;
+	unsigned char CombinationCharSize32;
+	wchar_t *pCombinationChars16;
+	char32_t *pCombinationChars32;
+	unsigned short ansi_char;				//  ANSI 
+	DWORD next_free;						// gpXg
+} buff_comb_t;
+
 #define BuffXMax TermWidthMax
 //#define BuffYMax 100000
 //#define BuffSizeMax 8000000
@@ -105,6 +113,14 @@ static LONG BufferSize;
 static int NumOfLinesInBuff;
 static int BuffStartAbs, BuffEndAbs;
 
+// e[u
+//	[0] ͎gpȂ(buff_char_t.comb == 0 ͌Ȃ)
+static buff_comb_t *CombTable;
+static DWORD CombTableSize;		// mۂĂGg
+static DWORD CombTableUsed;		// xłgpGg
+static DWORD CombTableFree;		// gpXg̐擪, 0=Ȃ
+static DWORD CombTableCount;	// gp̃Gg
+
 // I
 static BOOL Selected;		// TRUE=̈IsĂ
 static BOOL Selecting;
@@ -130,6 +146,17 @@ static int SaveBuffY;
 // ANSI\pɕϊƂCodePage
 static int CodePage = 932;
 
+// Zɏ񂾂Ƃ CodePage ̕\
+//	Zɂ index (buff_char_t.CodePageIdx) A
+//	ANSI͂ CodePage ŕϊ
+//	\tɂȂɏ񂾃Z CODE_PAGE_IDX_FALLBACK A
+//	̎_ CodePage ŕϊ(o^ς݂ index ͍ėpȂ)
+#define CODE_PAGE_TABLE_MAX 128
+#define CODE_PAGE_IDX_FALLBACK (CODE_PAGE_TABLE_MAX - 1)
+static int CodePageTable[CODE_PAGE_IDX_FALLBACK] = { 932 };
+static int CodePageTableCount = 1;
+static unsigned char CodePageIdx = 0;	// CodePage  index
+
 static void BuffDrawLineI(int DrawX, int DrawY, int SY, int IStart, int IEnd);
 static void BuffDrawLineIPrn(int SY, int IStart, int IEnd);
 
@@ -160,38 +187,222 @@ static buff_char_t *GetPtrRel(buff_char_t *CodeBuffW_, size_t BufferSize_, buff_
 	return p;
 }
 
-static void FreeCombinationBuf(buff_char_t *b)
+/**
+ *	e[ũGgmۂ
+ *
+ *	@retval	index (0=mۂłȂ)
+ *			CombTable  realloc() 邱Ƃ̂ŁA
+ *			|C^ێȂ
+ */
+static DWORD CombAlloc(void)
+{
+	DWORD idx;
+	if (CombTableFree != 0) {
+		idx = CombTableFree;
+		CombTableFree = CombTable[idx].next_free;
+	}
+	else {
+		if (CombTableUsed == 0) {
+			CombTableUsed = 1;	// [0]͎gpȂ
+		}
+		if (CombTableUsed >= CombTableSize) {
+			DWORD new_size = CombTableSize == 0 ? 64 : CombTableSize * 2;
+			buff_comb_t *new_table = realloc(CombTable, sizeof(buff_comb_t) * new_size);
+			if (new_table == NULL) {
+				return 0;
+			}
+			CombTable = new_table;
+			CombTableSize = new_size;
+		}
+		idx = CombTableUsed++;
+	}
+	memset(&CombTable[idx], 0, sizeof(CombTable[idx]));
+	CombTableCount++;
+	return idx;
+}
+
+static void CombFree(DWORD idx)
+{
+	buff_comb_t *c = &CombTable[idx];
+	assert(idx != 0 && idx < CombTableUsed);
+	free(c->pCombinationChars16);
+	free(c->pCombinationChars32);
+	memset(c, 0, sizeof(*c));
+	c->next_free = CombTableFree;
+	CombTableFree = idx;
+
+	CombTableCount--;
+	if (CombTableCount == 0) {
+		// gpĂȂ̂Ńe[uƊJ
+		free(CombTable);
+		CombTable = NULL;
+		CombTableSize = 0;
+		CombTableUsed = 0;
+		CombTableFree = 0;
+	}
+}
+
+/**
+ *	Ԃ
+ *	@retval	NULL	Ȃ
+ */
+static const buff_comb_t *GetComb(const buff_char_t *b)
+{
+	if (b->comb == 0) {
+		return NULL;
+	}
+	return &CombTable[b->comb];
+}
+
+static int GetCombCount16(const buff_char_t *b)
+{
+	const buff_comb_t *c = GetComb(b);
+	return c == NULL ? 0 : c->CombinationCharCount16;
+}
+
+static const wchar_t *GetComb16(const buff_char_t *b)
+{
+	const buff_comb_t *c = GetComb(b);
+	return c == NULL ? NULL : c->pCombinationChars16;
+}
+
+static int GetCombCount32(const buff_char_t *b)
 {
-	if (b->pCombinationChars16 != NULL) {
-		free(b->pCombinationChars16);
-		b->pCombinationChars16 = NULL;
+	const buff_comb_t *c = GetComb(b);
+	return c == NULL ? 0 : c->CombinationCharCount32;
+}
+
+static const char32_t *GetComb32(const buff_char_t *b)
+{
+	const buff_comb_t *c = GetComb(b);
+	return c == NULL ? NULL : c->pCombinationChars32;
+}
+
+/**
+ *	Ōɓ()ꂽ
+ */
+static char32_t GetU32Last(const buff_char_t *b)
+{
+	const buff_comb_t *c = GetComb(b);
+	return c == NULL ? b->u32 : c->u32_last;
+}
+
+/**
+ *	u32  UTF-16 ɓWJƂ1ڂԂ
+ *	TQ[gyÂƂ͏ʃTQ[g
+ */
+static wchar_t GetFirstWChar(const buff_char_t *b)
+{
+	if (b->u32 < 0x10000) {
+		return (wchar_t)b->u32;
+	}
+	return (wchar_t)(0xd800 + ((b->u32 - 0x10000) >> 10));
+}
+
+/**
+ *	u32  UTF-16 ɓWJ
+ *	@param[out]	wc2		TQ[gyAł͂ȂƂ wc2[1] = 0
+ */
+static void GetWC2(const buff_char_t *b, wchar_t *wc2)
+{
+	size_t wstr_len = UTF32ToUTF16(b->u32, &wc2[0], 2);
+	switch (wstr_len) {
+	case 0:
+	default:
+		wc2[0] = 0;
+		wc2[1] = 0;
+		break;
+	case 1:
+		wc2[1] = 0;
+		break;
+	case 2:
+		break;
+	}
+}
+
+/**
+ *	ANSIR[hԂ
+ *	ANSI\AANSI擾ɂKvȂ̂ŃZɂ͎A̓sxϊ
+ *	ϊɂ̓Z񂾂Ƃ CodePage g
+ *	鎞͌ɕϊlԂ
+ *
+ *	@return	1bytêƂ 0x00-0xff
+ *			2bytêƂ 8bit1byte
+ */
+static unsigned short GetANSIChar(const buff_char_t *b)
+{
+	const buff_comb_t *c = GetComb(b);
+	const char32_t u32 = b->u32;
+	const int code_page =
+		b->CodePageIdx == CODE_PAGE_IDX_FALLBACK ? CodePage : CodePageTable[b->CodePageIdx];
+	if (c != NULL) {
+		return c->ansi_char;
+	}
+
+	if (u32 < 0x80) {
+		return (unsigned short)u32;
+	}
+	else {
+		if (u32 == 0x203e && code_page == 932) {
+			// U+203e OVERLINE ʏ
+			//	 U+203e0x7e'~'ɕϊ
+			//return 0x7e7e;
+			return 0x7e;
+		}
+		else {
+			char strA[4];
+			size_t lenA = UTF32ToMBCP(u32, code_page, strA, sizeof(strA));
+			switch (lenA) {
+			case 0:
+			default:
+				return '?';
+			case 1:
+				return (unsigned char)strA[0];
+			case 2:
+				return (unsigned char)strA[1] | ((unsigned char)strA[0] << 8);
+			}
+		}
 	}
-	b->CombinationCharSize16 = 0;
-	b->CombinationCharCount16 = 0;
+}
 
-	if (b->pCombinationChars32 != NULL) {
-		free(b->pCombinationChars32);
-		b->pCombinationChars32 = NULL;
+static void FreeCombinationBuf(buff_char_t *b)
+{
+	if (b->comb != 0) {
+		CombFree(b->comb);
+		b->comb = 0;
 	}
-	b->CombinationCharSize32 = 0;
-	b->CombinationCharCount32 = 0;
 }
 
 static void DupCombinationBuf(buff_char_t *b)
 {
+	DWORD src_idx = b->comb;
+	DWORD idx;
+	buff_comb_t *c;
 	size_t size;
 
-	size = b->CombinationCharSize16;
+	if (src_idx == 0) {
+		return;
+	}
+	idx = CombAlloc();
+	b->comb = idx;
+	if (idx == 0) {
+		return;
+	}
+	c = &CombTable[idx];
+	*c = CombTable[src_idx];
+	c->next_free = 0;
+
+	size = c->CombinationCharSize16;
 	if (size > 0) {
 		wchar_t *new_buf = malloc(sizeof(wchar_t) * size);
-		memcpy(new_buf, b->pCombinationChars16, sizeof(wchar_t) * size);
-		b->pCombinationChars16 = new_buf;
+		memcpy(new_buf, c->pCombinationChars16, sizeof(wchar_t) * size);
+		c->pCombinationChars16 = new_buf;
 	}
-	size = b->CombinationCharSize32;
+	size = c->CombinationCharSize32;
 	if (size > 0) {
 		char32_t *new_buf = malloc(sizeof(char32_t) * size);
-		memcpy(new_buf, b->pCombinationChars32, sizeof(char32_t) * size);
-		b->pCombinationChars32 = new_buf;
+		memcpy(new_buf, c->pCombinationChars32, sizeof(char32_t) * size);
+		c->pCombinationChars32 = new_buf;
 	}
 }
 
@@ -213,61 +424,17 @@ static void CopyCombinationBuf(buff_char_t *dest, const buff_char_t *src)
 
 static void BuffSetChar2(buff_char_t *buff, char32_t u32, char property, BOOL half_width, char emoji)
 {
-	size_t wstr_len;
 	buff_char_t *p = buff;
 
 	FreeCombinationBuf(p);
 	p->WidthProperty = property;
 	p->cell = half_width ? 1 : 2;
 	p->u32 = u32;
-	p->u32_last = u32;
 	p->Padding = FALSE;
 	p->Emoji = emoji;
+	p->CodePageIdx = CodePageIdx;
 	p->fg = AttrDefaultFG;
 	p->bg = AttrDefaultBG;
-
-	//
-	wstr_len = UTF32ToUTF16(u32, &p->wc2[0], 2);
-	switch (wstr_len) {
-	case 0:
-	default:
-		p->wc2[0] = 0;
-		p->wc2[1] = 0;
-		break;
-	case 1:
-		p->wc2[1] = 0;
-		break;
-	case 2:
-		break;
-	}
-
-	if (u32 < 0x80) {
-		p->ansi_char = (unsigned short)u32;
-	}
-	else {
-		if (u32 == 0x203e && CodePage == 932) {
-			// U+203e OVERLINE ʏ
-			//	 U+203e0x7e'~'ɕϊ
-			//p->ansi_char = 0x7e7e;
-			p->ansi_char = 0x7e;
-		}
-		else {
-			char strA[4];
-			size_t lenA = UTF32ToMBCP(u32, CodePage, strA, sizeof(strA));
-			switch (lenA) {
-			case 0:
-			default:
-				p->ansi_char = '?';
-				break;
-			case 1:
-				p->ansi_char = (unsigned char)strA[0];
-				break;
-			case 2:
-				p->ansi_char = (unsigned char)strA[1] | ((unsigned char)strA[0] << 8);
-				break;
-			}
-		}
-	}
 }
 
 static void BuffSetChar4(buff_char_t *buff, char32_t u32, unsigned char fg, unsigned char bg, unsigned char attr, unsigned char attr2, char property)
@@ -290,8 +457,16 @@ static void BuffSetChar(buff_char_t *buff, char32_t u32, char property)
  */
 static void BuffAddChar(buff_char_t *buff, char32_t u32)
 {
-	buff_char_t *p = buff;
-	assert(p->u32 != 0);
+	buff_comb_t *p;
+	assert(buff->u32 != 0);
+	if (buff->comb == 0) {
+		buff->comb = CombAlloc();
+		if (buff->comb == 0) {
+			return;
+		}
+		CombTable[buff->comb].u32_last = buff->u32;
+	}
+	p = &CombTable[buff->comb];
 	// ɑ̈g傷
 	if (p->CombinationCharSize16 < p->CombinationCharCount16 + 2) {
 		size_t new_size = p->CombinationCharSize16;
@@ -1766,9 +1941,11 @@ static wchar_t *BuffGetStringForCB(int sx, int sy, int ex, int ey, BOOL box_sele
 		while (x < IEnd) {
 			const buff_char_t *b = &CodeBuffW[TmpPtr + x];
 			if (b->u32 != 0) {
-				str_w[k++] = b->wc2[0];
-				if (b->wc2[1] != 0) {
-					str_w[k++] = b->wc2[1];
+				wchar_t wc2[2];
+				GetWC2(b, wc2);
+				str_w[k++] = wc2[0];
+				if (wc2[1] != 0) {
+					str_w[k++] = wc2[1];
 				}
 				if (k + 2 >= str_size) {
 					str_size *= 2;
@@ -1777,12 +1954,14 @@ static wchar_t *BuffGetStringForCB(int sx, int sy, int ex, int ey, BOOL box_sele
 				{
 					int i;
 					// Rrl[V
-					if (k + b->CombinationCharCount16 >= str_size) {
-						str_size += + b->CombinationCharCount16;
+					const int comb_count = GetCombCount16(b);
+					const wchar_t *comb = GetComb16(b);
+					if (k + comb_count >= str_size) {
+						str_size += + comb_count;
 						str_w = realloc(str_w, sizeof(wchar_t) * str_size);
 					}
-					for (i = 0 ; i < (int)b->CombinationCharCount16; i++) {
-						str_w[k++] = b->pCombinationChars16[i];
+					for (i = 0 ; i < comb_count; i++) {
+						str_w[k++] = comb[i];
 					}
 				}
 			}
@@ -1827,6 +2006,8 @@ static wchar_t *BuffGetStringForCB(int sx, int sy, int ex, int ey, BOOL box_sele
 static size_t expand_wchar(const buff_char_t *b, wchar_t *buf, size_t buf_size, BOOL *too_samll)
 {
 	size_t len;
+	wchar_t wc2[2];
+	const int comb_count = GetCombCount16(b);
 
 	if (IsBuffPadding(b)) {
 		if (too_samll != NULL) {
@@ -1836,8 +2017,9 @@ static size_t expand_wchar(const buff_char_t *b, wchar_t *buf, size_t buf_size,
 	}
 
 	// 𑪂
+	GetWC2(b, wc2);
 	len = 0;
-	if (b->wc2[1] == 0) {
+	if (wc2[1] == 0) {
 		// TQ[gyAł͂Ȃ
 		len++;
 	} else {
@@ -1845,7 +2027,7 @@ static size_t expand_wchar(const buff_char_t *b, wchar_t *buf, size_t buf_size,
 		len += 2;
 	}
 	// Rrl[V
-	len += b->CombinationCharCount16;
+	len += comb_count;
 
 	if (buf == NULL) {
 		// Ԃ
@@ -1865,12 +2047,12 @@ static size_t expand_wchar(const buff_char_t *b, wchar_t *buf, size_t buf_size,
 	}
 
 	// WJĂ
-	*buf++ = b->wc2[0];
-	if (b->wc2[1] != 0) {
-		*buf++ = b->wc2[1];
+	*buf++ = wc2[0];
+	if (wc2[1] != 0) {
+		*buf++ = wc2[1];
 	}
-	if (b->CombinationCharCount16 != 0) {
-		memcpy(buf, b->pCombinationChars16, b->CombinationCharCount16 * sizeof(wchar_t));
+	if (comb_count != 0) {
+		memcpy(buf, GetComb16(b), comb_count * sizeof(wchar_t));
 	}
 
 	return len;
@@ -1889,12 +2071,15 @@ static size_t expand_wchar(const buff_char_t *b, wchar_t *buf, size_t buf_size,
 static size_t MatchOneStringPtr(const buff_char_t *b, const wchar_t *str, size_t len)
 {
 	int match_pos = 0;
+	wchar_t wc2[2];
+	const int comb_count = GetCombCount16(b);
 	if (len == 0) {
 		return 0;
 	}
-	if (b->wc2[1] == 0) {
+	GetWC2(b, wc2);
+	if (wc2[1] == 0) {
 		// TQ[gyAł͂Ȃ
-		if (str[match_pos] != b->wc2[0]) {
+		if (str[match_pos] != wc2[0]) {
 			return 0;
 		}
 		match_pos++;
@@ -1904,25 +2089,26 @@ static size_t MatchOneStringPtr(const buff_char_t *b, const wchar_t *str, size_t
 		if (len < 2) {
 			return 0;
 		}
-		if (str[match_pos+0] != b->wc2[0] ||
-			str[match_pos+1] != b->wc2[1]) {
+		if (str[match_pos+0] != wc2[0] ||
+			str[match_pos+1] != wc2[1]) {
 			return 0;
 		}
 		match_pos+=2;
 		len-=2;
 	}
-	if (b->CombinationCharCount16 > 0) {
+	if (comb_count > 0) {
 		// Rrl[V
+		const wchar_t *comb = GetComb16(b);
 		int i;
-		if (len < b->CombinationCharCount16) {
+		if (len < (size_t)comb_count) {
 			return 0;
 		}
-		for (i = 0 ; i < (int)b->CombinationCharCount16; i++) {
-			if (str[match_pos++] != b->pCombinationChars16[i]) {
+		for (i = 0 ; i < comb_count; i++) {
+			if (str[match_pos++] != comb[i]) {
 				return 0;
 			}
 		}
-		len -= b->CombinationCharCount16;
+		len -= comb_count;
 	}
 	return match_pos;
 }
@@ -2093,8 +2279,10 @@ static BOOL BuffGetMatchPosFromString(
 {
 	int IStart, IEnd;
 	int x, y;
+	const wchar_t first = str[0];
 
 	for (y = sy; y<=ey ; y++) {
+		const buff_char_t *b = &CodeBuffW[GetLinePtr(y)];
 		IStart = 0;
 		IEnd = NumOfColumns-1;
 		if (y== sy) {
@@ -2106,7 +2294,8 @@ static BOOL BuffGetMatchPosFromString(
 
 		x = IStart;
 		while (x <= IEnd) {
-			if (MatchString(x, y, str, TRUE)) {
+			// 1ڂقȂʒu MatchString() Ă΂ɔ΂
+			if (GetFirstWChar(&b[x]) == first && MatchString(x, y, str, TRUE)) {
 				// }b`
 				if (match_x != NULL) {
 					*match_x = x;
@@ -2266,12 +2455,12 @@ void BuffDumpCurrentLine(PrintFile *handle, BYTE TERM)
 	char *p = bufA;
 
 	i = NumOfColumns;
-	while ((i>0) && (b[i-1].ansi_char == 0x20)) {
+	while ((i>0) && (GetANSIChar(&b[i-1]) == 0x20)) {
 		i--;
 	}
 	p = bufA;
 	for (j=0; j<i; j++) {
-		unsigned short c = b[j].ansi_char;
+		unsigned short c = GetANSIChar(&b[j]);
 		*p++ = (c & 0xff);
 		if (c > 0x100) {
 			*p++ = (c & 0xff);
@@ -2747,20 +2936,25 @@ static void mark_url_w(int cur_x, int cur_y)
  */
 static wchar_t *GetWCS(const buff_char_t *b)
 {
-	size_t len = (b->wc2[1] == 0) ? 2 : 3;
+	size_t len;
+	wchar_t wc2[2];
 	wchar_t *strW;
 	wchar_t *p;
+	const int comb_count = GetCombCount16(b);
+	const wchar_t *comb = GetComb16(b);
 	int i;
 
-	len += b->CombinationCharCount16;
+	GetWC2(b, wc2);
+	len = (wc2[1] == 0) ? 2 : 3;
+	len += comb_count;
 	strW = malloc(sizeof(wchar_t) * len);
 	p = strW;
-	*p++ = b->wc2[0];
-	if (b->wc2[1] != 0) {
-		*p++ = b->wc2[1];
+	*p++ = wc2[0];
+	if (wc2[1] != 0) {
+		*p++ = wc2[1];
 	}
-	for (i=0; i<b->CombinationCharCount16; i++) {
-		*p++ = b->pCombinationChars16[i];
+	for (i=0; i<comb_count; i++) {
+		*p++ = comb[i];
 	}
 	*p = L'\0';
 	return strW;
@@ -2827,17 +3021,17 @@ static buff_char_t *IsCombiningChar(int x, int y, BOOL wrap, unsigned int u32, i
 
 	// ?
 	// 		1O ZWJ
-	if (combine_type != 0 || (p->u32_last == 0x200d)) {
+	if (combine_type != 0 || (GetU32Last(p) == 0x200d)) {
 		return p;
 	}
 
 	// B[}
-	if (UnicodeIsVirama(p->u32_last) != 0) {
+	if (UnicodeIsVirama(GetU32Last(p)) != 0) {
 		// 1ÕB[}Ɠ block ̕ł
-		int block_index_last = UnicodeBlockIndex(p->u32_last);
+		int block_index_last = UnicodeBlockIndex(GetU32Last(p));
 		int block_index = UnicodeBlockIndex(u32);
 #if 0
-		OutputDebugPrintf("U+%06x, %d, %s\n", p->u32_last, block_index_last, UnicodeBlockName(block_index_last));
+		OutputDebugPrintf("U+%06x, %d, %s\n", GetU32Last(p), block_index_last, UnicodeBlockName(block_index_last));
 		OutputDebugPrintf("U+%06x, %d, %s\n", u32, block_index, UnicodeBlockName(block_index));
 #endif
 		if (block_index_last == block_index) {
@@ -2956,7 +3150,7 @@ int BuffPutUnicode(unsigned int u32, const TCharAttr *Attr, BOOL Insert)
 
 		// ͕́ANonspacing mark ȊO?
 		//		J[\+1, +1
-		if (p->u32_last != 0x200d && combining_type != 1) {
+		if (GetU32Last(p) != 0x200d && combining_type != 1) {
 			// J[\ړʂ1
 			move_x = 1;
 
@@ -3025,7 +3219,10 @@ int BuffPutUnicode(unsigned int u32, const TCharAttr *Attr, BOOL Insert)
 		}
 
 		// ANSIR[hXV
-		p->ansi_char = ConvertACPChar(p);
+		if (p->comb != 0) {
+			unsigned short ansi_char = ConvertACPChar(p);
+			CombTable[p->comb].ansi_char = ansi_char;
+		}
 	}
 	else {
 		char width_property;
@@ -3253,6 +3450,85 @@ int BuffPutUnicode(unsigned int u32, const TCharAttr *Attr, BOOL Insert)
 	return move_x;
 }
 
+/**
+ *	󎚉\ASCII(0x20-0x7e)̕тobt@֓͂
+ *	BuffPutUnicode(㏑[h) + MoveRight() JԂ̂ƓʂɂȂ
+ *
+ *	- Ăяo Wrap łȂƁA}[hłȂƁA
+ *	  J[\ʒu + len szȂƂmF邱
+ *	- Sp̏㏑AASpɂȂ镶Ȃǂ͏ɖ߂
+ *	  c BuffPutUnicode() ŏ邱
+ *
+ *	@param[in]	s		(0x20-0x7e)
+ *	@param[in]	len		
+ *	@param[in]	Attr	attributes
+ *	@return		(J[\ړ)
+ */
+int BuffPutASCIIRun(const BYTE *s, int len, const TCharAttr *Attr)
+{
+	buff_char_t *CodeLineW = &CodeBuffW[LinePtr];
+	BYTE Attr_Attr = Attr->Attr;
+	int x = CursorX;
+	int i;
+
+	assert(Attr_Attr == (Attr->AttrEx & 0xff));
+	assert(CursorX + len <= NumOfColumns - 1);
+
+	if ((Attr->AttrEx & AttrPadding) != 0) {
+		return 0;
+	}
+	if (IsCombiningChar(CursorX, CursorY, Wrap, s[0], NULL) != NULL) {
+		// 1O̕(ZWJȂ)Ɍ
+		return 0;
+	}
+
+	for (i = 0; i < len; i++) {
+		buff_char_t *p = &CodeLineW[x];
+		const char32_t u32 = s[i];
+		char width_property;
+		char emoji;
+		BYTE a = Attr_Attr;
+
+		assert(0x20 <= u32 && u32 <= 0x7e);
+		if (IsBuffPadding(p) || IsBuffFullWidth(p)) {
+			// Sp̏㏑
+			break;
+		}
+		if (!BuffIsHalfWidthFromCode(&ts, u32, &width_property, &emoji)) {
+			// G̕ݒȂǂőSp
+			break;
+		}
+		if (ts.EnableContinuedLineCopy && x == 0 && (p->attr & AttrLineContinued)) {
+			a |= AttrLineContinued;
+		}
+
+		BuffSetChar2(p, u32, width_property, TRUE, emoji);
+		p->attr = a;
+		p->attr2 = Attr->Attr2;
+		p->fg = Attr->Fore;
+		p->bg = Attr->Back;
+
+		if (StrChangeCount == 0) {
+			StrChangeStart = x;
+		}
+		StrChangeCount++;
+
+		// URĽo
+		mark_url_w(x, CursorY);
+		x++;
+	}
+
+	if (i > 0) {
+		// MoveRight() ܂Ƃ߂čs
+		CursorX = x;
+		/* ŉsłXN[ */
+		if (ts.AutoScrollOnlyInBottomLine == 0 || WinOrgY == 0) {
+			DispScrollToCursor(CursorX, CursorY);
+		}
+	}
+	return i;
+}
+
 static BOOL CheckSelect(int x, int y)
 //  subroutine called by BuffUpdateRect
 {
@@ -3358,36 +3634,41 @@ void BuffGetDrawInfoW(int SY, int IStart, int IEnd,
 		}
 
 		if (SetString) {
+			const int comb_count = GetCombCount16(b);
+			wchar_t wc2[2];
+			GetWC2(b, wc2);
 			if (b->u32 < 0x10000) {
-				bufW[lenW] = b->wc2[0];
+				bufW[lenW] = wc2[0];
 				bufWW[lenW] = b->cell;
 				lenW++;
 			} else {
 				// UTF-16ŃTQ[gyA
-				bufW[lenW] = b->wc2[0];
+				bufW[lenW] = wc2[0];
 				bufWW[lenW] = 0;
 				lenW++;
-				bufW[lenW] = b->wc2[1];
+				bufW[lenW] = wc2[1];
 				bufWW[lenW] = b->cell;
 				lenW++;
 			}
-			if (b->CombinationCharCount16 != 0) {
+			if (comb_count != 0) {
 				// Rrl[V
+				const wchar_t *comb = GetComb16(b);
 				int i;
 				const char cell_tmp = bufWW[lenW - 1];
 				bufWW[lenW - 1] = 0;
-				for (i = 0; i < (int)b->CombinationCharCount16; i++) {
-					bufW[lenW + i] = b->pCombinationChars16[i];
+				for (i = 0; i < comb_count; i++) {
+					bufW[lenW + i] = comb[i];
 					bufWW[lenW + i] = 0;
 				}
-				bufWW[lenW + b->CombinationCharCount16 - 1] = cell_tmp;
-				lenW += b->CombinationCharCount16;
+				bufWW[lenW + comb_count - 1] = cell_tmp;
+				lenW += comb_count;
 				DrawFlag = TRUE;  // Rrl[Vꍇ͂`
 			}
 
 			// ANSI
-			{
-				unsigned short ansi_char = b->ansi_char;
+			//	Unicode API ŕ`悷鎞͕sv
+			if (!UseUnicodeApi) {
+				unsigned short ansi_char = GetANSIChar(b);
 				int i;
 				char cell = b->cell;
 				int c = 0;
@@ -5571,7 +5852,7 @@ int BuffGetAnyLineData(int offset_y, char *buf, int bufsize)
 		if (IsBuffPadding(b)) {
 			continue;
 		}
-		c = b->ansi_char;
+		c = GetANSIChar(b);
 		buf[idx++] = c & 0xff;
 		if (c >= 0x100) {
 			buf[idx++] = (c >> 8) & 0xff;
@@ -5791,7 +6072,7 @@ wchar_t *BuffGetCharInfo(int Xw, int Yw)
 	// ANSI
 	{
 		unsigned char mb[4];
-		unsigned short c = b->ansi_char;
+		unsigned short c = GetANSIChar(b);
 		if (c == 0) {
 			mb[0] = 0;
 		}
@@ -5824,22 +6105,26 @@ wchar_t *BuffGetCharInfo(int Xw, int Yw)
 	{
 		wchar_t *codes_ptr = NULL;
 		wchar_t *code_str;
+		wchar_t wc2[2];
+		const int comb_count = GetCombCount16(b);
+		const wchar_t *comb = GetComb16(b);
 		int i;
 
+		GetWC2(b, wc2);
 		aswprintf(&code_str,
 				  L"Unicode UTF-16:\n"
 				  L" 0x%04x\n",
-				  b->wc2[0]);
+				  wc2[0]);
 		awcscat(&codes_ptr, code_str);
 		free(code_str);
-		if (b->wc2[1] != 0 ) {
+		if (wc2[1] != 0 ) {
 			wchar_t buf[32];
-			swprintf(buf, _countof(buf), L" 0x%04x\n", b->wc2[1]);
+			swprintf(buf, _countof(buf), L" 0x%04x\n", wc2[1]);
 			awcscat(&codes_ptr, buf);
 		}
-		for (i=0; i<b->CombinationCharCount16; i++) {
+		for (i=0; i<comb_count; i++) {
 			wchar_t buf[32];
-			swprintf(buf, _countof(buf), L" 0x%04x\n", b->pCombinationChars16[i]);
+			swprintf(buf, _countof(buf), L" 0x%04x\n", comb[i]);
 			awcscat(&codes_ptr, buf);
 		}
 		unicode_utf16_str = codes_ptr;
@@ -5855,8 +6140,8 @@ wchar_t *BuffGetCharInfo(int Xw, int Yw)
 		code_str = UnicodeCodePointStr(b->u32);
 		awcscats(&codes_ptr, L" ", code_str, L"\n", NULL);
 		free(code_str);
-		for (i=0; i<b->CombinationCharCount32; i++) {
-			code_str = UnicodeCodePointStr(b->pCombinationChars32[i]);
+		for (i=0; i<GetCombCount32(b); i++) {
+			code_str = UnicodeCodePointStr(GetComb32(b)[i]);
 			awcscats(&codes_ptr, L" ", code_str, L"\n", NULL);
 			free(code_str);
 		}
@@ -5908,7 +6193,25 @@ void BuffSetDispAPI(BOOL unicode)
 
 void BuffSetDispCodePage(int code_page)
 {
+	int i;
+
 	CodePage = code_page;
+
+	// ɏ܂ĂZ͂̂Ƃ CodePage ̂܂ܕϊ
+	for (i = 0; i < CodePageTableCount; i++) {
+		if (CodePageTable[i] == code_page) {
+			CodePageIdx = (unsigned char)i;
+			return;
+		}
+	}
+	if (CodePageTableCount == CODE_PAGE_IDX_FALLBACK) {
+		// \t͓̎o^Ȃ
+		CodePageIdx = CODE_PAGE_IDX_FALLBACK;
+		return;
+	}
+	i = CodePageTableCount++;
+	CodePageTable[i] = code_page;
+	CodePageIdx = (unsigned char)i;
 }
 
 int BuffGetDispCodePage(void)
@@ -99,6 +99,7 @@ wchar_t *BuffCBCopyUnicode(BOOL Table);
 void BuffPrint(BOOL ScrollRegion);
 void BuffDumpCurrentLine(PrintFile *handle, BYTE TERM);
 int BuffPutUnicode(unsigned int uc, const TCharAttr *Attr, BOOL Insert);
+int BuffPutASCIIRun(const BYTE *s, int len, const TCharAttr *Attr);
 void BuffUpdateRect(int XStart, int YStart, int XEnd, int YEnd);
 void UpdateStr(void);
 void UpdateStrUnicode(void);
@@ -35,6 +35,10 @@
 #include <crtdbg.h>
 #include <assert.h>
 #include <windows.h>
+#if defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)) || defined(__SSE2__)
+#include <emmintrin.h>
+#define USE_SSE2 1
+#endif
 
 #include "ttwinman.h"	// for ts
 #include "codeconv.h"
@@ -891,6 +895,105 @@ void ParseFirst(CharSetData *w, BYTE b)
 		w->Op.PutU32(b, w->ClientData);
 }
 
+/**
+ *	݂̏Ԃň󎚉\ASCII(0x20-0x7e)̂܂܏o͂邩
+ *
+ *	@retval	TRUE	ParseFirst()  b(0x20-0x7e) ͂ PutU32(b) Ă΂
+ */
+static BOOL IsASCIIThrough(const CharSetData *w)
+{
+	if (w->DebugFlag != DEBUG_FLAG_NONE) {
+		return FALSE;
+	}
+	if (w->SSflag || w->Gn[w->Glr[0]] != IdASCII) {
+		// VOVtgAGL  ASCII ȊO(DECꕶȂ)
+		return FALSE;
+	}
+
+	switch (ts.KanjiCode) {
+	case IdSJIS:
+	case IdEUC:
+	case IdJIS:
+		return !w->KanjiIn && !w->EUCkanaIn && !w->EUCsupIn;
+
+	case IdUTF8:
+		return w->count == 0 && !w->Fallbacked;
+
+	case IdKoreanCP949:
+	case IdCnGB2312:
+	case IdCnBig5:
+		return !w->KanjiIn;
+
+	case IdISO8859_1:
+	case IdISO8859_2:
+	case IdISO8859_3:
+	case IdISO8859_4:
+	case IdISO8859_5:
+	case IdISO8859_6:
+	case IdISO8859_7:
+	case IdISO8859_8:
+	case IdISO8859_9:
+	case IdISO8859_10:
+	case IdISO8859_11:
+	case IdISO8859_13:
+	case IdISO8859_14:
+	case IdISO8859_15:
+	case IdISO8859_16:
+	case IdWindows:
+	case IdKOI8:
+	case Id866:
+	case IdISO:
+		return TRUE;
+
+	default:
+		return FALSE;
+	}
+}
+
+/**
+ *	擪AĂ󎚉\(0x20-0x7e)̐Ԃ
+ *
+ *	߂l̐ ParseFirst() ĂԂƁAebytê܂ PutU32() 
+ *	(Ԃ͕ωȂ)̂ŁAĂяoł܂Ƃ߂ď邱Ƃł
+ *	ԂASCIÎ܂܏o͂Ȃ(̓rADECꕶȂ) 0 Ԃ
+ *
+ *	@param	ptr		Mf[^
+ *	@param	len		Mf[^
+ *	@return	܂Ƃ߂ďłbyte
+ */
+size_t CharSetPrintableRun(CharSetData *w, const BYTE *ptr, size_t len)
+{
+	size_t i = 0;
+
+	if (!IsASCIIThrough(w)) {
+		return 0;
+	}
+
+#if defined(USE_SSE2)
+	{
+		// tŔr 0x80-0xff ͕ɂȂ
+		const __m128i lo = _mm_set1_epi8(0x1f);
+		const __m128i hi = _mm_set1_epi8(0x7f);
+		while (i + 16 <= len) {
+			__m128i v = _mm_loadu_si128((const __m128i *)(ptr + i));
+			__m128i ok = _mm_and_si128(_mm_cmpgt_epi8(v, lo), _mm_cmplt_epi8(v, hi));
+			if (_mm_movemask_epi8(ok) != 0xffff) {
+				// 16byteɔ͈͊OAc1byte
+				break;
+			}
+			i += 16;
+		}
+	}
+#endif
+	for (; i < len; i++) {
+		BYTE b = ptr[i];
+		if (b < 0x20 || b > 0x7e) {
+			break;
+		}
+	}
+	return i;
+}
+
 /**
  *	w(Designate)
  *
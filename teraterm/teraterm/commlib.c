@@ -272,6 +272,49 @@ error:
 	return (ret);
 }
 
+/**
+ *	Mobt@mۂ
+ *	TCYςȂƂ͑Omۂ̂g
+ */
+static void CommAllocInBuff(PComVar cv, int size)
+{
+	if (size < InBuffSize) {
+		size = InBuffSize;
+	}
+	else if (size > InBuffSizeMax) {
+		size = InBuffSizeMax;
+	}
+
+	if (cv->InBuff == NULL || cv->InBuffCapacity != size) {
+		if (cv->InBuff != cv->InBuffFixed) {
+			free(cv->InBuff);
+		}
+		cv->InBuff = (BYTE *)malloc(size);
+		if (cv->InBuff == NULL) {
+			// mۂłȂƂ͌Œ蒷obt@g
+			cv->InBuff = cv->InBuffFixed;
+			size = InBuffSize;
+		}
+		cv->InBuffCapacity = size;
+	}
+	cv->InBuffCount = 0;
+	cv->InPtr = 0;
+}
+
+/**
+ *	Mobt@
+ */
+static void CommFreeInBuff(PComVar cv)
+{
+	if (cv->InBuff != cv->InBuffFixed) {
+		free(cv->InBuff);
+	}
+	cv->InBuff = NULL;
+	cv->InBuffCapacity = 0;
+	cv->InBuffCount = 0;
+	cv->InPtr = 0;
+}
+
 void CommOpen(HWND HW, PTTSet ts, PComVar cv)
 {
 	char ErrMsg[21 + 256];
@@ -292,8 +335,7 @@ void CommOpen(HWND HW, PTTSet ts, PComVar cv)
 	}
 
 	/* initialize ComVar */
-	cv->InBuffCount = 0;
-	cv->InPtr = 0;
+	CommAllocInBuff(cv, ts->RecvBufferSize);
 	cv->OutBuffCount = 0;
 	cv->OutPtr = 0;
 	cv->HWin = HW;
@@ -888,6 +930,9 @@ void CommClose(PComVar cv)
 	cv->PortType = 0;
 	free(cv->TitleRemoteW);
 	cv->TitleRemoteW = NULL;
+
+	/*  CommOpen() Őݒ̃TCYŊmۂ */
+	CommFreeInBuff(cv);
 }
 
 void CommProcRRQ(PComVar cv)
@@ -913,34 +958,29 @@ void CommReceive(PComVar cv)
 {
 	DWORD C;
 	DWORD DErr;
+	BYTE *ptr;
+	int len;
 
-	if (! cv->Ready || ! cv->RRQ ||
-	    (cv->InBuffCount>=InBuffSize)) {
+	if (! cv->Ready || ! cv->RRQ) {
 		return;
 	}
 
-	/* Compact buffer */
-	if ((cv->InBuffCount>0) && (cv->InPtr>0)) {
-		memmove(cv->InBuff,&(cv->InBuff[cv->InPtr]),cv->InBuffCount);
-		cv->InPtr = 0;
-	}
-
-	if (cv->InBuffCount<InBuffSize) {
+	/* Mobt@̓Oobt@A󂢂ĂÄ֓ǂݍ */
+	len = CommInBuffWriteSpan(cv, &ptr);
+	if (len > 0) {
 		switch (cv->PortType) {
 			case IdTCPIP:
-				C = Precv(cv->s, &(cv->InBuff[cv->InBuffCount]),
-				          InBuffSize-cv->InBuffCount, 0);
+				C = Precv(cv->s, ptr, len, 0);
 				if (C == SOCKET_ERROR) {
 					C = 0;
 					PWSAGetLastError();
 				}
-				cv->InBuffCount = cv->InBuffCount + C;
+				CommInBuffWriteCommit(cv, C);
 				break;
 			case IdSerial:
 				do {
 					ClearCommError(cv->ComID,&DErr,NULL);
-					if (! PReadFile(cv->ComID,&(cv->InBuff[cv->InBuffCount]),
-					                InBuffSize-cv->InBuffCount,&C,&rol)) {
+					if (! PReadFile(cv->ComID,ptr,len,&C,&rol)) {
 						if (GetLastError() == ERROR_IO_PENDING) {
 							if (WaitForSingleObject(rol.hEvent, 1000) != WAIT_OBJECT_0) {
 								C = 0;
@@ -953,18 +993,21 @@ void CommReceive(PComVar cv)
 							C = 0;
 						}
 					}
-					cv->InBuffCount = cv->InBuffCount + C;
-				} while ((C!=0) && (cv->InBuffCount<InBuffSize));
+					CommInBuffWriteCommit(cv, C);
+					if (C == 0) {
+						break;
+					}
+					len = CommInBuffWriteSpan(cv, &ptr);
+				} while (len > 0);
 				ClearCommError(cv->ComID,&DErr,NULL);
 				break;
 			case IdFile:
-				if (PReadFile(cv->ComID,&(cv->InBuff[cv->InBuffCount]),
-				              InBuffSize-cv->InBuffCount,&C,NULL)) {
+				if (PReadFile(cv->ComID,ptr,len,&C,NULL)) {
 					if (C == 0) {
 						DErr = ERROR_HANDLE_EOF;
 					}
 					else {
-						cv->InBuffCount = cv->InBuffCount + C;
+						CommInBuffWriteCommit(cv, C);
 					}
 				}
 				else {
@@ -975,13 +1018,12 @@ void CommReceive(PComVar cv)
 			case IdNamedPipe:
 				// L[̒ɍŒ1oCgȏ̃f[^Ă邱ƂmFłĂ邽߁A
 				// ReadFile() ̓ubN邱Ƃ͂Ȃ߁AꊇēǂށB
-				if (PReadFile(cv->ComID,&(cv->InBuff[cv->InBuffCount]),
-				              InBuffSize-cv->InBuffCount,&C,NULL)) {
+				if (PReadFile(cv->ComID,ptr,len,&C,NULL)) {
 					if (C == 0) {
 						DErr = ERROR_HANDLE_EOF;
 					}
 					else {
-						cv->InBuffCount = cv->InBuffCount + C;
+						CommInBuffWriteCommit(cv, C);
 					}
 				}
 				else {
@@ -68,6 +68,22 @@ enum enumLineEnd {
 	Line_FileHead = 2,
 };
 
+/*
+ *	Oobt@
+ *	Oobt@
+ *	ݑ(LogRingPut)Ɠǂݏo(LogRingPeek/LogRingConsume)
+ *	ꂼ1ȂArȂĂ悢 (single producer / single consumer)
+ *	- head, tail ͏/ǂݏooCgAsize Ŋ]肪ʒu
+ *	- 󂫂ȂƂ͏܂Ɏ̂āÂĂoCg lost ɐ
+ */
+typedef struct {
+	BYTE *buf;
+	size_t size;			// 2ׂ̂
+	volatile size_t head;	// ݑ̂ݍXV
+	volatile size_t tail;	// ǂݏôݍXV
+	volatile LONG lost;		// ӂĎ̂ĂoCg
+} LogRing;
+
 typedef struct {
 	wchar_t *FullName;
 
@@ -83,9 +99,14 @@ typedef struct {
 	LONG RotateSize;
 	int RotateStep;
 
+	// x
+	//	Xbh Ring ǂݏoăt@C֏
+	LogRing *Ring;
 	HANDLE LogThread;
-	DWORD LogThreadId;
-	HANDLE LogThreadEvent;
+	HANDLE LogThreadWake;		// XbhN
+	volatile LONG LogThreadQuit;
+	size_t CountedHead;			// ByteCount ɐ Ring ̈ʒu
+	volatile LONG FlushLatency;	// f[^Ă珑ނ܂ł̎(ms)
 
 	BOOL IsPause;
 
@@ -101,20 +122,27 @@ typedef TFileVar *PFileVar;
 
 static PFileVar LogVar = NULL;
 
-static PCHAR cv_LogBuf;
-static int cv_LogPtr, cv_LStart, cv_LCount;
-static PCHAR cv_BinBuf;
-static int cv_BinPtr, cv_BStart, cv_BCount;
+#define LOG_BUFF_SIZE	(256 * 1024)
+
+static LogRing cv_LogBuf;
+static LogRing cv_BinBuf;
 static int cv_BinSkip;
 
-// xݗpXbh̃bZ[W
-#define WM_DPC_LOGTHREAD_SEND (WM_APP + 1)
+// x
+#define LOG_FLUSH_SIZE		(64 * 1024)	// ܂珑ރTCY
+#define LOG_FLUSH_ALIGN		4096		// TCYŏނƂ͂̔{ŏ
+#define LOG_FLUSH_INTERVAL	200			// ܂ȂĂގ(ms)
 
 static void Log1Bin(BYTE b);
 static void LogBinSkip(int add);
 static BOOL CreateLogBuf(void);
 static BOOL CreateBinBuf(void);
 void LogPut1(BYTE b);
+static void LogRingPut(LogRing *r, const BYTE *data, size_t len);
+static size_t LogRingPeek(const LogRing *r, const BYTE **ptr);
+static void LogRingConsume(LogRing *r, size_t len);
+static size_t LogRingCount(const LogRing *r);
+static void LogPutBytes(const BYTE *data, size_t len);
 static void OutputStr(const wchar_t *str);
 static void LogToFile(PFileVar fv);
 static void FLogOutputBOM(PFileVar fv);
@@ -254,83 +282,108 @@ static void FixLogOption(void)
 // Xbh̏Iƃt@C̃N[Y
 static void CloseFileSync(PFileVar fv)
 {
-	BOOL ret;
-
 	if (fv->FileHandle == INVALID_HANDLE_VALUE) {
 		return;
 	}
 
 	if (fv->LogThread != INVALID_HANDLE_VALUE) {
 		// Xbh̏I҂
-		ret = PostThreadMessage(fv->LogThreadId, WM_QUIT, 0, 0);
-		if (ret != 0) {
-			// XbhL[ɃGL[łꍇ̂ݑ҂킹sB
-			WaitForSingleObject(fv->LogThread, INFINITE);
-		}
-		else {
-			//DWORD code = GetLastError();
-		}
+		//	Xbh͎cĂf[^ׂďłI
+		fv->LogThreadQuit = TRUE;
+		SetEvent(fv->LogThreadWake);
+		WaitForSingleObject(fv->LogThread, INFINITE);
 		CloseHandle(fv->LogThread);
 		fv->LogThread = INVALID_HANDLE_VALUE;
+		CloseHandle(fv->LogThreadWake);
+		fv->LogThreadWake = NULL;
 	}
 	CloseHandle(fv->FileHandle);
 	fv->FileHandle = INVALID_HANDLE_VALUE;
 }
 
-// xݗpXbh
+/**
+ *	Oobt@ len oCgt@C֏
+ */
+static void LogRingWriteFile(HANDLE hFile, LogRing *ring, size_t len)
+{
+	while (len > 0) {
+		const BYTE *ptr;
+		DWORD wrote;
+		size_t n = LogRingPeek(ring, &ptr);
+		if (n > len) {
+			n = len;
+		}
+		WriteFile(hFile, ptr, (DWORD)n, &wrote, NULL);
+		LogRingConsume(ring, n);
+		len -= n;
+	}
+}
+
+/**
+ *	xݗpXbh
+ *
+ *	Ring ɗ܂f[^܂Ƃ߂ď
+ *	- LOG_FLUSH_SIZE ȏ㗭܂ LOG_FLUSH_ALIGN ̔{
+ *	- f[^Ă LOG_FLUSH_INTERVAL o炷ׂď
+ *	- Iׂ͂ď
+ */
 static unsigned _stdcall DeferredLogWriteThread(void *arg)
 {
-	MSG msg;
 	PFileVar fv = (PFileVar)arg;
-	PCHAR buf;
-	DWORD buflen;
-	DWORD wrote;
-
-	PeekMessage(&msg, NULL, 0, 0, PM_NOREMOVE);
-
-	// XbhL[̍쐬IƂXbh֒ʒmB
-	if (fv->LogThreadEvent != NULL) {
-		SetEvent(fv->LogThreadEvent);
-	}
+	LogRing *ring = fv->Ring;
+	BOOL pending = FALSE;
+	DWORD pending_since = 0;
+
+	for (;;) {
+		BOOL quit;
+		size_t count;
+		size_t len = 0;
+
+		WaitForSingleObject(fv->LogThreadWake, pending ? LOG_FLUSH_INTERVAL : INFINITE);
+		quit = fv->LogThreadQuit;
+
+		count = LogRingCount(ring);
+		if (count > 0 && !pending) {
+			pending = TRUE;
+			pending_since = GetTickCount();
+		}
+		if (quit || (pending && GetTickCount() - pending_since >= LOG_FLUSH_INTERVAL)) {
+			len = count;
+		}
+		else if (count >= LOG_FLUSH_SIZE) {
+			len = count & ~((size_t)LOG_FLUSH_ALIGN - 1);
+		}
 
-	while (GetMessage(&msg, NULL, 0, 0) > 0) {
-		switch (msg.message) {
-			case WM_DPC_LOGTHREAD_SEND:
-				buf = (PCHAR)msg.wParam;
-				buflen = (DWORD)msg.lParam;
-				WriteFile(fv->FileHandle, buf, buflen, &wrote, NULL);
-				free(buf);   // Ń
-				break;
+		if (len > 0) {
+			LogRingWriteFile(fv->FileHandle, ring, len);
+			fv->FlushLatency = (LONG)(GetTickCount() - pending_since);
+			pending = LogRingCount(ring) > 0;
+			pending_since = GetTickCount();
+		}
 
-			case WM_QUIT:
-				goto end;
-				break;
+		if (quit) {
+			break;
 		}
 	}
 
-end:
 	_endthreadex(0);
 	return (0);
 }
 
 // xݗpXbhNB
-// (2013.4.19 yutaka)
-// DeferredLogWriteThread XbhNāAXbhL[쐬OɁA
-// Ot@C̃N[Y(CloseFileSync)sƁAGL[sAfbhbN
-// ƂCB
-// XbhԂ̓s߁AOȂCxgIuWFNggāAXbhL[
-// 쐬܂ő҂킹悤ɂBOtCxgIuWFNggꍇ́A
-// VXe(Windows OS)Ńj[NȖOɂKvB
-// (2016.9.23 yutaka)
 static void StartThread(PFileVar fv)
 {
 	unsigned tid;
-	fv->LogThreadEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+	fv->LogThreadQuit = FALSE;
+	fv->LogThreadWake = CreateEvent(NULL, FALSE, FALSE, NULL);
+	if (fv->LogThreadWake == NULL) {
+		return;
+	}
 	fv->LogThread = (HANDLE)_beginthreadex(NULL, 0, DeferredLogWriteThread, fv, 0, &tid);
-	fv->LogThreadId = tid;
-	if (fv->LogThreadEvent != NULL) {
-		WaitForSingleObject(fv->LogThreadEvent, INFINITE);
-		CloseHandle(fv->LogThreadEvent);
+	if (fv->LogThread == NULL) {
+		fv->LogThread = INVALID_HANDLE_VALUE;
+		CloseHandle(fv->LogThreadWake);
+		fv->LogThreadWake = NULL;
 	}
 }
 
@@ -359,6 +412,7 @@ static BOOL LogStart(PFileVar fv, const wchar_t *fname)
 		{
 			return FALSE;
 		}
+		fv->Ring = &cv_BinBuf;
 	}
 	else {
 		fv->BinLog = FALSE;
@@ -367,10 +421,9 @@ static BOOL LogStart(PFileVar fv, const wchar_t *fname)
 		{
 			return FALSE;
 		}
+		fv->Ring = &cv_LogBuf;
 	}
-	cv_LStart = cv_LogPtr;
-	cv_LCount = 0;
-
+	fv->CountedHead = fv->Ring->head;
 	OpenLogFile(fv);
 	if (fv->FileHandle == INVALID_HANDLE_VALUE) {
 		return FALSE;
@@ -460,6 +513,96 @@ void FLogOutputAllBuffer(void)
 	}
 }
 
+static BOOL LogRingCreate(LogRing *r, size_t size)
+{
+	r->buf = (BYTE *)malloc(size);
+	r->size = size;
+	r->head = 0;
+	r->tail = 0;
+	r->lost = 0;
+	return r->buf != NULL;
+}
+
+static void LogRingDestroy(LogRing *r)
+{
+	free(r->buf);
+	r->buf = NULL;
+	r->size = 0;
+	r->head = 0;
+	r->tail = 0;
+	r->lost = 0;
+}
+
+/**
+ *	ǂݏooCg
+ */
+static size_t LogRingCount(const LogRing *r)
+{
+	return r->head - r->tail;
+}
+
+/**
+ *	߂oCg
+ */
+static size_t LogRingSpace(const LogRing *r)
+{
+	return r->size - (r->head - r->tail);
+}
+
+/**
+ *	
+ *	󂫂ȂƂ͏܂Ȃ(̓rŐ؂Ȃ悤ŜĂ)
+ */
+static void LogRingPut(LogRing *r, const BYTE *data, size_t len)
+{
+	const size_t head = r->head;
+	size_t pos;
+	size_t n;
+
+	if (LogRingSpace(r) < len) {
+		InterlockedExchangeAdd(&r->lost, (LONG)len);
+		return;
+	}
+	// ǂݏo tail i߂Oɓǂ񂾃f[^㏑Ȃ
+	MemoryBarrier();
+
+	pos = head & (r->size - 1);
+	n = r->size - pos;
+	if (n >= len) {
+		memcpy(r->buf + pos, data, len);
+	}
+	else {
+		memcpy(r->buf + pos, data, n);
+		memcpy(r->buf, data + n, len - n);
+	}
+
+	// f[^IĂ head i߂
+	MemoryBarrier();
+	r->head = head + len;
+}
+
+/**
+ *	AēǂݏöԂ
+ *	ǂݏo LogRingConsume() Ă
+ *
+ *	@return	oCg
+ */
+static size_t LogRingPeek(const LogRing *r, const BYTE **ptr)
+{
+	const size_t count = LogRingCount(r);
+	const size_t pos = r->tail & (r->size - 1);
+	const size_t n = r->size - pos;
+	MemoryBarrier();
+	*ptr = r->buf + pos;
+	return count < n ? count : n;
+}
+
+static void LogRingConsume(LogRing *r, size_t len)
+{
+	MemoryBarrier();
+	r->tail = r->tail + len;
+}
+
 /**
  * O1byte
  *		obt@֏܂
@@ -467,36 +610,19 @@ void FLogOutputAllBuffer(void)
  */
 void LogPut1(BYTE b)
 {
-	PFileVar fv = LogVar;
-
-	cv_LogBuf[cv_LogPtr] = b;
-	cv_LogPtr++;
-	if (cv_LogPtr>=InBuffSize)
-		cv_LogPtr = cv_LogPtr-InBuffSize;
-
-	if (fv->FileLog)
-	{
-		if (cv_LCount>=InBuffSize)
-		{
-			cv_LCount = InBuffSize;
-			cv_LStart = cv_LogPtr;
-		}
-		else
-			cv_LCount++;
-	}
-	else
-		cv_LCount = 0;
+	LogPutBytes(&b, 1);
 }
 
-static BOOL Get1(PCHAR Buf, int *Start, int *Count, PBYTE b)
+/**
+ *	Oobt@֏
+ *	|[Ŷ͎Ă
+ */
+static void LogPutBytes(const BYTE *data, size_t len)
 {
-	if (*Count<=0) return FALSE;
-	*b = Buf[*Start];
-	(*Start)++;
-	if (*Start>=InBuffSize)
-		*Start = *Start-InBuffSize;
-	(*Count)--;
-	return TRUE;
+	if (FLogIsPause() || ProtoGetProtoFlag()) {
+		return;
+	}
+	LogRingPut(&cv_LogBuf, data, len);
 }
 
 
@@ -623,75 +749,47 @@ static wchar_t *TimeStampStr(PFileVar fv)
  */
 static void LogToFile(PFileVar fv)
 {
-	PCHAR Buf;
-	int Start, Count;
-	BYTE b;
+	LogRing *ring;
 
 	if (fv->FileLog)
 	{
-		Buf = cv_LogBuf;
-		Start = cv_LStart;
-		Count = cv_LCount;
+		ring = &cv_LogBuf;
 	}
 	else if (fv->BinLog)
 	{
-		Buf = cv_BinBuf;
-		Start = cv_BStart;
-		Count = cv_BCount;
+		ring = &cv_BinBuf;
 	}
 	else
 		return;
 
-	if (Buf==NULL) return;
-	if (Count==0) return;
+	if (ring->buf==NULL) return;
+	if (ring->head == fv->CountedHead) return;
 
 	// bN(2004.8.6 yutaka)
 	logfile_lock();
 
-	// ݃f[^쐬
-	DWORD WriteBufMax = 8192;
-	DWORD WriteBufLen = 0;
-	PCHAR WriteBuf = (PCHAR)malloc(WriteBufMax);
-	while (Get1(Buf,&Start,&Count,&b)) {
-		if (FLogIsPause() || ProtoGetProtoFlag()) {
-			continue;
-		}
-
-		if (WriteBufLen >= (WriteBufMax*4/5)) {
-			WriteBufMax *= 2;
-			WriteBuf = (PCHAR)realloc(WriteBuf, WriteBufMax);
-		}
-
-		WriteBuf[WriteBufLen++] = b;
-
-		(fv->ByteCount)++;
+	if (fv->LogThread != INVALID_HANDLE_VALUE) {
+		// ݂̓Xbhs
+		const size_t head = ring->head;
+		fv->ByteCount += (LONG)(head - fv->CountedHead);
+		fv->CountedHead = head;
+		SetEvent(fv->LogThreadWake);
 	}
-
-	// 
-	if (WriteBufLen > 0) {
-		if (ts.DeferredLogWriteMode) {
-			PostThreadMessage(fv->LogThreadId, WM_DPC_LOGTHREAD_SEND, (WPARAM)WriteBuf, WriteBufLen);
-		}
-		else {
-			DWORD wrote;
-			WriteFile(fv->FileHandle, WriteBuf, WriteBufLen, &wrote, NULL);
-			free(WriteBuf);
-		}
+	else {
+		// Oobt@璼ڏ
+		const size_t len = LogRingCount(ring);
+		LogRingWriteFile(fv->FileHandle, ring, len);
+		fv->ByteCount += (LONG)len;
+		fv->CountedHead = ring->head;
 	}
 
 	logfile_unlock();
 
-	if (fv->FileLog)
-	{
-		cv_LStart = Start;
-		cv_LCount = Count;
-	}
-	else {
-		cv_BStart = Start;
-		cv_BCount = Count;
-	}
 	if (FLogIsPause() || ProtoGetProtoFlag()) return;
-	fv->FLogDlg->RefreshNum(fv->StartTime, fv->FileSize, fv->ByteCount);
+	fv->FLogDlg->RefreshNum(fv->StartTime, fv->FileSize, fv->ByteCount, ring->lost);
+	if (fv->LogThread != INVALID_HANDLE_VALUE) {
+		fv->FLogDlg->RefreshLogStat(fv->StartTime, fv->ByteCount, (LONG)LogRingCount(ring), fv->FlushLatency);
+	}
 
 
 	// OE[e[g
@@ -700,44 +798,30 @@ static void LogToFile(PFileVar fv)
 
 static BOOL CreateLogBuf(void)
 {
-	if (cv_LogBuf==NULL)
+	if (cv_LogBuf.buf==NULL)
 	{
-		cv_LogBuf = (char *)malloc(InBuffSize);
-		cv_LogPtr = 0;
-		cv_LStart = 0;
-		cv_LCount = 0;
+		return LogRingCreate(&cv_LogBuf, LOG_BUFF_SIZE);
 	}
-	return (cv_LogBuf!=NULL);
+	return TRUE;
 }
 
 static void FreeLogBuf(void)
 {
-	free(cv_LogBuf);
-	cv_LogBuf = NULL;
-	cv_LogPtr = 0;
-	cv_LStart = 0;
-	cv_LCount = 0;
+	LogRingDestroy(&cv_LogBuf);
 }
 
 static BOOL CreateBinBuf(void)
 {
-	if (cv_BinBuf==NULL)
+	if (cv_BinBuf.buf==NULL)
 	{
-		cv_BinBuf = (PCHAR)malloc(InBuffSize);
-		cv_BinPtr = 0;
-		cv_BStart = 0;
-		cv_BCount = 0;
+		return LogRingCreate(&cv_BinBuf, LOG_BUFF_SIZE);
 	}
-	return (cv_BinBuf!=NULL);
+	return TRUE;
 }
 
 static void FreeBinBuf(void)
 {
-	free(cv_BinBuf);
-	cv_BinBuf = NULL;
-	cv_BinPtr = 0;
-	cv_BStart = 0;
-	cv_BCount = 0;
+	LogRingDestroy(&cv_BinBuf);
 }
 
 static void FileTransEnd_(PFileVar fv)
@@ -1132,29 +1216,19 @@ static void Log1Bin(BYTE b)
 		cv_BinSkip--;
 		return;
 	}
-	cv_BinBuf[cv_BinPtr] = b;
-	cv_BinPtr++;
-	if (cv_BinPtr>=InBuffSize) {
-		cv_BinPtr = cv_BinPtr-InBuffSize;
-	}
-	if (cv_BCount>=InBuffSize) {
-		cv_BCount = InBuffSize;
-		cv_BStart = cv_BinPtr;
-	}
-	else {
-		cv_BCount++;
-	}
+	LogRingPut(&cv_BinBuf, &b, 1);
 }
 
 static void LogBinSkip(int add)
 {
-	if (cv_BinBuf != NULL) {
+	if (cv_BinBuf.buf != NULL) {
 		cv_BinSkip += add;
 	}
 }
 
 /**
  *	Oobt@ɗ܂Ăf[^̃oCgԂ
+ *	x݃Xbh֓nf[^͊܂܂Ȃ
  */
 int FLogGetCount(void)
 {
@@ -1162,11 +1236,8 @@ int FLogGetCount(void)
 	if (fv == NULL) {
 		return 0;
 	}
-	if (fv->FileLog) {
-		return cv_LCount;
-	}
-	if (fv->BinLog) {
-		return cv_BCount;
+	if (fv->FileLog || fv->BinLog) {
+		return (int)(fv->Ring->head - fv->CountedHead);
 	}
 	return 0;
 }
@@ -1181,10 +1252,10 @@ int FLogGetFreeCount(void)
 		return 0;
 	}
 	if (fv->FileLog) {
-		return InBuffSize - cv_LCount;
+		return (int)LogRingSpace(&cv_LogBuf);
 	}
 	if (fv->BinLog) {
-		return InBuffSize - cv_BCount;
+		return (int)LogRingSpace(&cv_BinBuf);
 	}
 	return 0;
 }
@@ -1198,14 +1269,14 @@ void FLogWriteFile(void)
 	if (fv == NULL) {
 		return;
 	}
-	if (cv_LogBuf!=NULL)
+	if (cv_LogBuf.buf!=NULL)
 	{
 		if (fv->FileLog) {
 			LogToFile(fv);
 		}
 	}
 
-	if (cv_BinBuf!=NULL)
+	if (cv_BinBuf.buf!=NULL)
 	{
 		if (fv->BinLog) {
 			LogToFile(fv);
@@ -1213,16 +1284,11 @@ void FLogWriteFile(void)
 	}
 }
 
-void FLogPutUTF32(unsigned int u32)
+/**
+ *	sȂ^CX^vo͂
+ */
+static void OutputTimeStamp(PFileVar fv)
 {
-	PFileVar fv = LogVar;
-	BOOL log_available = (cv_LogBuf != 0);
-
-	if (!log_available) {
-		// Oɂ͏o͂Ȃ
-		return;
-	}
-
 	// s?(so͂)
 	if (ts.LogTimestamp && fv->eLineEnd) {
 		// ^CX^vo
@@ -1231,16 +1297,45 @@ void FLogPutUTF32(unsigned int u32)
 		FLogWriteStr(strtime);
 		free(strtime);
 	}
+}
+
+/**
+ *	UTF-16 O̕R[hɍ킹ĕׂ
+ *	@return	oCg
+ */
+static size_t PutUTF16Bytes(PFileVar fv, wchar_t u16, BYTE *buf)
+{
+	if (fv->log_code == LOG_UTF16LE) {
+		// UTF-16LE
+		buf[0] = u16 & 0xff;
+		buf[1] = (u16 >> 8) & 0xff;
+	}
+	else {
+		// UTF-16BE
+		buf[0] = (u16 >> 8) & 0xff;
+		buf[1] = u16 & 0xff;
+	}
+	return 2;
+}
+
+void FLogPutUTF32(unsigned int u32)
+{
+	PFileVar fv = LogVar;
+	BOOL log_available = (cv_LogBuf.buf != NULL);
+	BYTE buf[8];
+	size_t len = 0;
+
+	if (!log_available) {
+		// Oɂ͏o͂Ȃ
+		return;
+	}
+
+	OutputTimeStamp(fv);
 
 	switch(fv->log_code) {
 	case LOG_UTF8: {
 		// UTF-8
-		char u8_buf[4];
-		size_t u8_len = UTF32ToUTF8(u32, u8_buf, _countof(u8_buf));
-		for (size_t i = 0; i < u8_len; i++) {
-			BYTE b = u8_buf[i];
-			LogPut1(b);
-		}
+		len = UTF32ToUTF8(u32, (char *)buf, 4);
 		break;
 	}
 	case LOG_UTF16LE:
@@ -1249,25 +1344,52 @@ void FLogPutUTF32(unsigned int u32)
 		wchar_t u16[2];
 		size_t u16_len = UTF32ToUTF16(u32, u16, _countof(u16));
 		for (size_t i = 0; i < u16_len; i++) {
-			if (fv->log_code == LOG_UTF16LE) {
-				// UTF-16LE
-				LogPut1(u16[i] & 0xff);
-				LogPut1((u16[i] >> 8) & 0xff);
-			}
-			else {
-				// UTF-16BE
-				LogPut1((u16[i] >> 8) & 0xff);
-				LogPut1(u16[i] & 0xff);
-			}
+			len += PutUTF16Bytes(fv, u16[i], &buf[len]);
 		}
 	}
 	}
+	LogPutBytes(buf, len);
 
 	if (u32 == 0x0a) {
 		fv->eLineEnd = Line_LineHead; /* set endmark*/
 	}
 }
 
+/**
+ *	󎚉\ASCII(0x20-0x7e)܂Ƃ߂ăO֏o͂
+ *	FLogPutUTF32() 1ĂԂ̂Ɠ
+ */
+void FLogPutASCII(const BYTE *s, size_t len)
+{
+	PFileVar fv = LogVar;
+
+	if (cv_LogBuf.buf == NULL || len == 0) {
+		// Oɂ͏o͂Ȃ
+		return;
+	}
+
+	OutputTimeStamp(fv);
+
+	if (fv->log_code == LOG_UTF8) {
+		// UTF-8 ͂̂܂
+		LogPutBytes(s, len);
+		return;
+	}
+
+	// UTF-16
+	while (len > 0) {
+		BYTE buf[256];
+		size_t n = len < sizeof(buf) / 2 ? len : sizeof(buf) / 2;
+		size_t buf_len = 0;
+		for (size_t i = 0; i < n; i++) {
+			buf_len += PutUTF16Bytes(fv, s[i], &buf[buf_len]);
+		}
+		LogPutBytes(buf, buf_len);
+		s += n;
+		len -= n;
+	}
+}
+
 static void FLogOutputBOM(PFileVar fv)
 {
 	DWORD wrote;
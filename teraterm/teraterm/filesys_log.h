@@ -71,6 +71,7 @@ int FLogGetCount(void);
 int FLogGetFreeCount(void);
 void FLogWriteFile(void);
 void FLogPutUTF32(unsigned int u32);
+void FLogPutASCII(const BYTE *s, size_t len);
 void FLogOutputAllBuffer(void);
 
 #ifdef __cplusplus
@@ -149,9 +149,9 @@ void CFileTransDlg::ChangeButton(BOOL PauseFlag)
 	}
 }
 
-void CFileTransDlg::RefreshNum(DWORD StartTime, LONG FileSize, LONG ByteCount)
+void CFileTransDlg::RefreshNum(DWORD StartTime, LONG FileSize, LONG ByteCount, LONG LostCount)
 {
-	char NumStr[24];
+	char NumStr[48];
 	double rate;
 	int rate2;
 	static DWORD prev_elapsed;
@@ -191,11 +191,34 @@ void CFileTransDlg::RefreshNum(DWORD StartTime, LONG FileSize, LONG ByteCount)
 		SetDlgItemText(IDC_TRANSBYTES, NumStr);
 	}
 	else {
-		_snprintf_s(NumStr,sizeof(NumStr),_TRUNCATE,"%u",ByteCount);
+		if (LostCount > 0) {
+			// obt@ӂď߂Ȃ
+			_snprintf_s(NumStr,sizeof(NumStr),_TRUNCATE,"%u (lost %u)",ByteCount,LostCount);
+		}
+		else {
+			_snprintf_s(NumStr,sizeof(NumStr),_TRUNCATE,"%u",ByteCount);
+		}
 		SetDlgItemText(IDC_TRANSBYTES, NumStr);
 	}
 }
 
+/**
+ *	O̒x݂̏Ԃ\
+ *
+ *	@param	QueueBytes		ݑ҂̃oCg
+ *	@param	FlushLatency	f[^Ă珑ނ܂ł̎(ms)
+ */
+void CFileTransDlg::RefreshLogStat(DWORD StartTime, LONG ByteCount, LONG QueueBytes, LONG FlushLatency)
+{
+	char NumStr[64];
+	DWORD elapsed = (GetTickCount() - StartTime) / 1000;
+	LONG rate = elapsed == 0 ? 0 : (LONG)(ByteCount / elapsed);
+
+	_snprintf_s(NumStr, sizeof(NumStr), _TRUNCATE, "%d.%02dKB/s q:%dKB %dms",
+				rate / 1000, rate / 10 % 100, QueueBytes / 1024, FlushLatency);
+	SetDlgItemText(IDC_TRANS_ETIME, NumStr);
+}
+
 /////////////////////////////////////////////////////////////////////////////
 // CFileTransDlg message handler
 
@@ -57,7 +57,8 @@ public:
 
 	BOOL Create(HINSTANCE hInstance, Info *info);
 	void ChangeButton(BOOL PauseFlag);
-	void RefreshNum(DWORD StartTime, LONG FileSize, LONG ByteCount);
+	void RefreshNum(DWORD StartTime, LONG FileSize, LONG ByteCount, LONG LostCount = 0);
+	void RefreshLogStat(DWORD StartTime, LONG ByteCount, LONG QueueBytes, LONG FlushLatency);
 
 private:
 	virtual BOOL OnCancel();
@@ -47,12 +47,17 @@
 typedef int (CALLBACK *PSSH_start_scp)(char *, char *);
 typedef int (CALLBACK * PSSH_scp_sending_status)(void);
 typedef size_t (CALLBACK *PSSH_GetKnownHostsFileName)(wchar_t *, size_t);
+typedef int (CALLBACK *PSSH_start_sftp)(char *, char *, int);
+typedef int (CALLBACK *PSSH_sftp_transfer_status)(void);
 
 static HMODULE h = NULL;
 static PSSH_start_scp start_scp = NULL;
 static PSSH_start_scp receive_file = NULL;
 static PSSH_scp_sending_status scp_sending_status = NULL;
 static PSSH_GetKnownHostsFileName GetKnownHostsFileName;
+static PSSH_start_sftp sftp_send_file = NULL;
+static PSSH_start_sftp sftp_receive_file = NULL;
+static PSSH_sftp_transfer_status sftp_transfer_status = NULL;
 
 /**
  * @brief SCP֐̃AhX擾
@@ -187,3 +192,114 @@ BOOL TTXSSHGetKnownHostsFileName(wchar_t **filename)
 	*filename = f;
 	return TRUE;
 }
+
+/**
+ * @brief SFTP֐̃AhX擾
+ *	SFTP]ɑΉĂȂ ttxssh.dll ł SCP ͎g悤AScpInit() Ƃ͕ʂɎ擾
+ * @retval TRUE ok
+ * @retval FALSE dllȂ/dllsftp]ɑΉĂȂ
+ */
+static BOOL SftpInit(void)
+{
+	if (h == NULL) {
+		if ((h = GetModuleHandle("ttxssh.dll")) == NULL) {
+			return FALSE;
+		}
+	}
+
+	if (sftp_send_file == NULL) {
+		sftp_send_file = (PSSH_start_sftp)GetProcAddress(h, "TTXSftpSendfile");
+		if (sftp_send_file == NULL) {
+			return FALSE;
+		}
+	}
+	if (sftp_receive_file == NULL) {
+		sftp_receive_file = (PSSH_start_sftp)GetProcAddress(h, "TTXSftpReceivefile");
+		if (sftp_receive_file == NULL) {
+			return FALSE;
+		}
+	}
+	if (sftp_transfer_status == NULL) {
+		sftp_transfer_status = (PSSH_sftp_transfer_status)GetProcAddress(h, "TTXSftpTransferStatus");
+		if (sftp_transfer_status == NULL) {
+			return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
+/**
+ *	SFTPŃt@C𑗐M
+ *	@param	local	[J(PC,Windows)̃t@C
+ *	@param	remote	[g(sshT[o[)̃t@C
+ *					L""Ń[JƓt@C
+ *	@param	resume	TRUÊƂA[gɂr܂ł̃t@C̑瑗
+ *	@return TRUE	ok(NGXgł)
+ *	@return FALSE	ng
+ */
+BOOL SftpSend(const wchar_t *local, const wchar_t *remote, BOOL resume)
+{
+	if (sftp_send_file == NULL) {
+		SftpInit();
+	}
+	if (sftp_send_file == NULL) {
+		return FALSE;
+	}
+	char *localU8 = ToU8W(local);
+	char *remoteU8 = ToU8W(remote);
+	BOOL r = (BOOL)sftp_send_file(localU8, remoteU8, resume);
+	free(localU8);
+	free(remoteU8);
+	return r;
+}
+
+/**
+ *	SFTPŃt@CM
+ *	@param	resume	TRUÊƂA[Jɂr܂ł̃t@C̑󂯎
+ */
+BOOL SftpReceive(const wchar_t *remotefile, const wchar_t *localfile, BOOL resume)
+{
+	if (sftp_receive_file == NULL) {
+		SftpInit();
+	}
+	if (sftp_receive_file == NULL) {
+		return FALSE;
+	}
+	char *localU8 = ToU8W(localfile);
+	char *remoteU8 = ToU8W(remotefile);
+	BOOL r = (BOOL)sftp_receive_file(remoteU8, localU8, resume);
+	free(localU8);
+	free(remoteU8);
+	return r;
+}
+
+/**
+ *	ttxssh.dll  SFTP ]ɑΉĂ邩
+ *	@retval	TRUE	ΉĂ
+ *	@retval	FALSE	dllȂ/dllsftp]ɑΉĂȂ
+ */
+BOOL SftpIsSupported(void)
+{
+	if (sftp_send_file == NULL || sftp_receive_file == NULL || sftp_transfer_status == NULL) {
+		SftpInit();
+	}
+	return sftp_send_file != NULL && sftp_receive_file != NULL && sftp_transfer_status != NULL;
+}
+
+/**
+ *	SFTP]
+ *	@retval	SFTP_STATUS_IDLE	]ĂȂ(Ō̓]͐)
+ *	@retval	SFTP_STATUS_BUSY	]
+ *	@retval	SFTP_STATUS_ERROR	Ō̓]͎s
+ */
+int SftpGetStatus(void)
+{
+	if (sftp_transfer_status == NULL) {
+		SftpInit();
+	}
+	if (sftp_transfer_status == NULL) {
+		return SFTP_STATUS_ERROR;
+	}
+	return sftp_transfer_status();
+}
@@ -32,10 +32,19 @@
 extern "C" {
 #endif
 
+// SftpGetStatus() ̖߂l (ttxssh.dll  TTXSftpTransferStatus() Ɠl)
+#define SFTP_STATUS_IDLE	0
+#define SFTP_STATUS_BUSY	1
+#define SFTP_STATUS_ERROR	2
+
 BOOL ScpSend(const wchar_t *local, const wchar_t *remote);
 BOOL ScpGetStatus(void);
 BOOL ScpReceive(const wchar_t *remotefile, const wchar_t *localfile);
 BOOL TTXSSHGetKnownHostsFileName(wchar_t **filename);
+BOOL SftpSend(const wchar_t *local, const wchar_t *remote, BOOL resume);
+BOOL SftpReceive(const wchar_t *remotefile, const wchar_t *localfile, BOOL resume);
+BOOL SftpIsSupported(void);
+int SftpGetStatus(void);
 
 #ifdef __cplusplus
 }
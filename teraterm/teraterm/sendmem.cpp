@@ -278,7 +278,8 @@ static void GetInBuffInfo(const TComVar *cv_, size_t *use, size_t *free)
 		*use = cv_->InBuffCount;
 	}
 	if (free != NULL) {
-		*free = InBuffSize - cv_->InBuffCount;
+		int f = cv_->InBuffCapacity - InBuffInsertMargin - cv_->InBuffCount;
+		*free = f > 0 ? f : 0;
 	}
 }
 
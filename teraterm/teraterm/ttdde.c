@@ -68,6 +68,11 @@
 
 #define MaxStrLen (LONG)512
 
+// }Nւ̑Mobt@̃TCY
+//   Mobt@(cv.InBuff)Ƃ͕ʂ̃obt@
+//   }N̎MOobt@(ttmdde.c RingBufSize)\Ă
+#define DDEBuffSize InBuffSize
+
 BOOL DDELog = FALSE;		// macro (DDE) Lǂ
 char TopicName[21] = "";
 static HCONV ConvH = 0;
@@ -93,10 +98,30 @@ static LONG SyncFreeSpace;
 static char ParamFileName[MaxStrLen];
 static WORD ParamBinaryFlag;
 static WORD ParamXmodemOpt;
+static BOOL ParamSftpResume;
 static char ParamSecondFileName[MaxStrLen];
 
 static BOOL AutoLogClose = FALSE;
 
+/**
+ *	^C}[SFTP]̏I`FbNA}NɌʂԂ
+ */
+static void CALLBACK SftpTimerProc(HWND hWnd, UINT msg, UINT_PTR nIDEvent, DWORD dwTime)
+{
+	int status = SftpGetStatus();
+	(void)msg;
+	(void)dwTime;
+
+	// ]?
+	if (status == SFTP_STATUS_BUSY) {
+		// ̃^C}[C^[oōēx`FbN
+		return;
+	}
+
+	KillTimer(hWnd, nIDEvent);
+	EndDdeCmnd(status == SFTP_STATUS_IDLE ? 1 : 0);
+}
+
 static char *cv_LogBuf;
 static int cv_LogPtr;
 static int cv_DStart;
@@ -114,12 +139,12 @@ void DDEPut1(BYTE b)
 
 	cv_LogBuf[cv_LogPtr] = b;
 	cv_LogPtr++;
-	if (cv_LogPtr >= InBuffSize)
-		cv_LogPtr = cv_LogPtr - InBuffSize;
+	if (cv_LogPtr >= DDEBuffSize)
+		cv_LogPtr = cv_LogPtr - DDEBuffSize;
 
-	if (cv_DCount >= InBuffSize)
+	if (cv_DCount >= DDEBuffSize)
 	{
-		cv_DCount = InBuffSize;
+		cv_DCount = DDEBuffSize;
 		cv_DStart = cv_LogPtr;
 	}
 	else
@@ -128,7 +153,7 @@ void DDEPut1(BYTE b)
 
 static BOOL DDECreateBuf(void)
 {
-	cv_LogBuf = (char *)malloc(InBuffSize);
+	cv_LogBuf = (char *)malloc(DDEBuffSize);
 	if (cv_LogBuf == NULL) {
 		return FALSE;
 	}
@@ -254,8 +279,8 @@ static BOOL DDEGet1(LPBYTE b)
 	if (cv_DCount <= 0) return FALSE;
 	*b = ((LPSTR)cv_LogBuf)[cv_DStart];
 	cv_DStart++;
-	if (cv_DStart>=InBuffSize)
-		cv_DStart = cv_DStart-InBuffSize;
+	if (cv_DStart>=DDEBuffSize)
+		cv_DStart = cv_DStart-DDEBuffSize;
 	cv_DCount--;
 	return TRUE;
 }
@@ -274,7 +299,7 @@ static LONG DDEGetDataLen()
 		b = ((LPSTR)cv_LogBuf)[Start];
 		if ((b==0x00) || (b==0x01)) Len++;
 		Start++;
-		if (Start>=InBuffSize) Start = Start-InBuffSize;
+		if (Start>=DDEBuffSize) Start = Start-DDEBuffSize;
 		Count--;
 	}
 
@@ -289,6 +314,14 @@ int DDEGetCount(void)
 	return cv_DCount;
 }
 
+/**
+ *	Mobt@̋󂫗eʎ擾
+ */
+int DDEGetFreeCount(void)
+{
+	return DDEBuffSize - cv_DCount;
+}
+
 static HDDEDATA AcceptRequest(HSZ ItemHSz)
 {
 	BYTE b;
@@ -563,6 +596,9 @@ static HDDEDATA AcceptExecute(HSZ TopicHSz, HDDEDATA Data)
 		ParamXmodemOpt = Command[1] & 3;
 		if (ParamXmodemOpt==0) ParamXmodemOpt = 1;
 		break;
+	case CmdSetSftpOpt:
+		ParamSftpResume = (Command[1] & 1) != 0;
+		break;
 	case CmdSetSync:
 		if (sscanf(&(Command[1]),"%lu",&SyncFreeSpace)!=1)
 			SyncFreeSpace = 0;
@@ -958,6 +994,39 @@ static HDDEDATA AcceptExecute(HSZ TopicHSz, HDDEDATA Data)
 		}
 		break;
 
+	case CmdSftpSend:
+	case CmdSftpRcv:
+		{
+			wchar_t *ParamFileNameW = ToWcharU8(ParamFileName);
+			wchar_t *ParamSecondFileNameW = ToWcharU8(ParamSecondFileName);
+			BOOL r;
+			if (Command[0] == CmdSftpSend) {
+				r = SftpSend(ParamFileNameW, ParamSecondFileNameW, ParamSftpResume);
+			}
+			else {
+				r = SftpReceive(ParamFileNameW, ParamSecondFileNameW, ParamSftpResume);
+			}
+			free(ParamFileNameW);
+			free(ParamSecondFileNameW);
+			if (r == FALSE) {
+				// bZ[W dll  sftp ɑΉĂȂꍇoB
+				// ڑA]At@CJȂȂǂœ]n߂Ȃ̏ꍇ͏oȂB
+				if (!SftpIsSupported()) {
+					const char *msg = "ttxssh.dll not support sftp";
+					MessageBox(NULL, msg, Command[0] == CmdSftpSend ?
+					           "Tera Term: sftpsend command error" : "Tera Term: sftprecv command error",
+					           MB_OK | MB_ICONERROR);
+				}
+				result = DDE_FNOTPROCESSED;
+			}
+			else {
+				// ]I܂Ń}N҂
+				DdeCmnd = TRUE;
+				SetTimer(HVTWin, IdSftpTimer, 100, SftpTimerProc);
+			}
+		}
+		break;
+
 	case CmdSetBaud:  // add 'setbaud' (2008.2.13 steven patch)
 		{
 		int val;
@@ -895,6 +895,69 @@ static void PutU32(unsigned int code)
 	OutputLogUTF32(code);
 }
 
+/**
+ *	󎚉\ASCII(0x20-0x7e)܂Ƃ߂ăO֏o͂
+ *	OutputLogUTF32() 1ĂԂ̂Ɠ
+ */
+static void OutputLogASCIIRun(const BYTE *s, int len)
+{
+	int i;
+	if (FLogIsOpendText() && !DDELog && !PrinterMode) {
+		// 1ڂŉsۗ̕(CR)̂ŁA
+		// 2ڈȍ~ CheckEOLCheck() ʂ̂܂܏o͂ł
+		OutputLogUTF32(s[0]);
+		FLogPutASCII(s + 1, len - 1);
+		return;
+	}
+	for (i = 0; i < len; i++) {
+		OutputLogUTF32(s[i]);
+	}
+}
+
+/**
+ *	󎚉\(0x20-0x7e)̕тobt@֏
+ *	Oɂ
+ *
+ *	PutU32()  len ĂԂ̂ƓʂɂȂ
+ *	s܂ł̔p͂܂Ƃ߂ BuffPutASCIIRun() ŏ
+ *	DECꕶwĂȂ(CharSetPrintableRun()ŊmFς)
+ */
+static void PutPrintableRun(const BYTE *s, int len)
+{
+	while (len > 0) {
+		int n = 0;
+		if (!Wrap && !InsertMode) {
+			int LineEnd;
+			if (CursorX > CursorRightM)
+				LineEnd = NumOfColumns - 1;
+			else
+				LineEnd = CursorRightM;
+
+			// s̕ Wrap ̂ PutU32() ŏ
+			n = LineEnd - CursorX;
+			if (n > len) {
+				n = len;
+			}
+			if (n > 0) {
+				TCharAttr CharAttrTmp = CharAttr;
+				CharAttrTmp.AttrEx = CharAttrTmp.Attr;
+				n = BuffPutASCIIRun(s, n, &CharAttrTmp);
+			}
+		}
+
+		if (n > 0) {
+			LastPutCharacter = s[n - 1];
+			OutputLogASCIIRun(s, n);
+		}
+		else {
+			PutU32(s[0]);
+			n = 1;
+		}
+		s += n;
+		len -= n;
+	}
+}
+
 static void RepeatChar(char32_t b, int count)
 {
 	int i;
@@ -5279,7 +5342,7 @@ static void CANSeen(BYTE b)
  */
 static int CommRead1Byte_(PComVar cv, LPBYTE b)
 {
-	if (DDELog && DDEGetCount() >= InBuffSize - 10) {
+	if (DDELog && DDEGetFreeCount() <= 10) {
 		/* obt@ɗ]TȂꍇ */
 		Sleep(1);
 		return 0;
@@ -5296,6 +5359,79 @@ static int CommRead1Byte_(PComVar cv, LPBYTE b)
 	return CommRead1Byte(cv, b);
 }
 
+/**
+ *	Mobt@ɘAĂ󎚉\(0x20-0x7e)܂Ƃ߂ď
+ *	ParseMode  ModeFirst ̂Ƃ̂݌Ăяo
+ *
+ *	CommRead1Byte_() 1byteĂԏꍇƓʂɂȂ
+ *	󎚉\̏ CommInsert1Byte()  ChangeEmu ̕ύX͔Ȃ
+ *	R[h̏ԂASCIÎ܂܏o͂鎞́AfR[_ʂ
+ *	PutPrintableRun() ł܂Ƃ߂ăobt@֏
+ *
+ *	@return	byte
+ */
+static int ParsePrintableRun(void)
+{
+	const BYTE *ptr;
+	int len;
+	int i;
+
+	len = CommReadSpan(&cv, &ptr);
+	if (len == 0) {
+		return 0;
+	}
+
+	// CommRead1Byte_() ̗]T`FbNɍ킹ď𐧌
+	if (DDELog) {
+		int limit = DDEGetFreeCount() - 10;
+		if (len > limit) {
+			len = limit;
+		}
+	}
+	if (FLogIsOpend()) {
+		// O1ő2byte(UTF-16)
+		int limit = (FLogGetFreeCount() - FILESYS_LOG_FREE_SPACE) / 2;
+		if (len > limit) {
+			len = limit;
+		}
+	}
+
+	if (len <= 0) {
+		return 0;
+	}
+
+	i = (int)CharSetPrintableRun(charset_data, ptr, len);
+	if (i > 0) {
+		// ɏĂ
+		//	ɎMobt@ւ݂͔̏Ȃ̂ ptr ͂̂܂܎g
+		len = i;
+		CommReadSpanCommit(&cv, len);
+		PutPrintableRun(ptr, len);
+		PrevCharacter = ptr[len - 1];
+		return len;
+	}
+
+	// ̓rȂǁA1bytefR[_ŏ
+	for (i = 0; i < len; i++) {
+		BYTE b = ptr[i];
+		if (b < 0x20 || b > 0x7e) {
+			break;
+		}
+	}
+	len = i;
+	if (len <= 0) {
+		return 0;
+	}
+
+	CommReadSpanCommit(&cv, len);
+	for (i = 0; i < len; i++) {
+		ParseFirst(charset_data, ptr[i]);
+	}
+	PrevCharacter = ptr[len - 1];
+
+	return len;
+}
+
 int VTParse()
 {
 	BYTE b;
@@ -5370,8 +5506,14 @@ int VTParse()
 			LastPutCharacter = 0;
 		}
 
-		if (ChangeEmu==0)
+		if (ChangeEmu==0) {
+#if !defined(DEBUG_DUMP_INPUTCODE)
+			if (ParseMode == ModeFirst) {
+				ParsePrintableRun();
+			}
+#endif
 			c = CommRead1Byte_(&cv,&b);
+		}
 	}
 
 	BuffUpdateScroll();
@@ -484,6 +484,57 @@ void WINAPI BroadcastClosingMessage(HWND myhwnd)
 }
 
 
+/**
+ *	Mobt@̋󂫗̈̂AAď߂͈͂Ԃ
+ *	CommInsert1Byte() p̗̈(InBuffInsertMargin)͊܂܂Ȃ
+ *
+ *	@param[out]	ptr		݉\ȗ̈̐擪
+ *	@return				݉\byte
+ *
+ *	񂾕 CommInBuffWriteCommit() Ŋm肷邱
+ */
+int WINAPI CommInBuffWriteSpan(PComVar cv, BYTE **ptr)
+{
+	int free_len;
+	int wp;
+	int len;
+
+	if (cv->InBuff == NULL) {
+		return 0;
+	}
+	free_len = cv->InBuffCapacity - InBuffInsertMargin - cv->InBuffCount;
+	if (free_len <= 0) {
+		return 0;
+	}
+
+	if (cv->InBuffCount == 0) {
+		cv->InPtr = 0;
+	}
+	wp = cv->InPtr + cv->InBuffCount;
+	if (wp >= cv->InBuffCapacity) {
+		wp -= cv->InBuffCapacity;
+	}
+	len = cv->InBuffCapacity - wp;
+	if (len > free_len) {
+		len = free_len;
+	}
+
+	*ptr = &(cv->InBuff[wp]);
+	return len;
+}
+
+/**
+ *	CommInBuffWriteSpan() œ̈ɏ len byte m肷
+ */
+void WINAPI CommInBuffWriteCommit(PComVar cv, int len)
+{
+	assert(0 <= len && cv->InBuffCount + len <= cv->InBuffCapacity);
+	if (len <= 0) {
+		return;
+	}
+	cv->InBuffCount += len;
+}
+
 int WINAPI CommReadRawByte(PComVar cv, LPBYTE b)
 {
 	if ( ! cv->Ready ) {
@@ -493,6 +544,9 @@ int WINAPI CommReadRawByte(PComVar cv, LPBYTE b)
 	if ( cv->InBuffCount>0 ) {
 		*b = cv->InBuff[cv->InPtr];
 		cv->InPtr++;
+		if (cv->InPtr >= cv->InBuffCapacity) {
+			cv->InPtr = 0;
+		}
 		cv->InBuffCount--;
 		if ( cv->InBuffCount==0 ) {
 			cv->InPtr = 0;
@@ -505,6 +559,54 @@ int WINAPI CommReadRawByte(PComVar cv, LPBYTE b)
 	}
 }
 
+/**
+ *	Mobt@Atelnets킸ɂ̂܂ܓǂݏo͈͂Ԃ
+ *	IAC(0xff)telnetCRȂǁACommRead1Byte() ŏKvbyte̎O܂
+ *
+ *	@param[out]	ptr		ǂݏo\ȗ̈̐擪
+ *	@return				ǂݏo\byte
+ *						0̂Ƃ CommRead1Byte() œǂݏo
+ *
+ *	ǂݏo CommReadSpanCommit() ŏ邱
+ */
+int WINAPI CommReadSpan(PComVar cv, const BYTE **ptr)
+{
+	const BYTE *start;
+	const BYTE *end;
+	const BYTE *p;
+
+	if ( ! cv->Ready ) {
+		return 0;
+	}
+	if ( (cv->InBuffCount <= 0) || cv->TelMode || cv->IACFlag || cv->TelCRFlag ) {
+		return 0;
+	}
+
+	// Oobt@̏I[Ő܂ԂO܂
+	start = &(cv->InBuff[cv->InPtr]);
+	if (cv->InPtr + cv->InBuffCount > cv->InBuffCapacity) {
+		end = &(cv->InBuff[cv->InBuffCapacity]);
+	}
+	else {
+		end = start + cv->InBuffCount;
+	}
+	if ((cv->PortType==IdTCPIP) && (cv->TelFlag || cv->TelAutoDetect)) {
+		p = (const BYTE *)memchr(start, 0xFF, end - start);
+		if (p != NULL) {
+			end = p;
+		}
+	}
+	if (cv->TelFlag && ! cv->TelBinRecv) {
+		p = (const BYTE *)memchr(start, 0x0D, end - start);
+		if (p != NULL) {
+			end = p;
+		}
+	}
+
+	*ptr = start;
+	return (int)(end - start);
+}
+
 static void LogBinSkip(PComVar cv, int add)
 {
 	if (cv->LogBinSkip != NULL) {
@@ -517,13 +619,16 @@ void WINAPI CommInsert1Byte(PComVar cv, BYTE b)
 	if ( ! cv->Ready ) {
 		return;
 	}
+	if (cv->InBuffCount >= cv->InBuffCapacity) {
+		// InBuffInsertMargin 󂯂Ă̂Œʏ͋NȂ
+		assert(FALSE);
+		return;
+	}
 
 	if (cv->InPtr == 0) {
-		memmove(&(cv->InBuff[1]),&(cv->InBuff[0]),cv->InBuffCount);
-	}
-	else {
-		cv->InPtr--;
+		cv->InPtr = cv->InBuffCapacity;
 	}
+	cv->InPtr--;
 	cv->InBuff[cv->InPtr] = b;
 	cv->InBuffCount++;
 
@@ -590,6 +695,42 @@ int WINAPI CommRead1Byte(PComVar cv, LPBYTE b)
 	return c;
 }
 
+/**
+ *	CommReadSpan() œ̈̐擪 len byte 
+ *	CommRead1Byte()  len Ă񂾂̂ƓɂȂ
+ */
+void WINAPI CommReadSpanCommit(PComVar cv, int len)
+{
+	if ( ! cv->Ready ) {
+		return;
+	}
+	assert(0 <= len && len <= cv->InBuffCount);
+	if (len <= 0) {
+		return;
+	}
+
+	if (cv->Log1Bin != NULL) {
+		int ptr = cv->InPtr;
+		int i;
+		for (i = 0; i < len; i++) {
+			cv->Log1Bin(cv->InBuff[ptr]);
+			ptr++;
+			if (ptr >= cv->InBuffCapacity) {
+				ptr = 0;
+			}
+		}
+	}
+
+	cv->InPtr += len;
+	if (cv->InPtr >= cv->InBuffCapacity) {
+		cv->InPtr -= cv->InBuffCapacity;
+	}
+	cv->InBuffCount -= len;
+	if ( cv->InBuffCount==0 ) {
+		cv->InPtr = 0;
+	}
+}
+
 int WINAPI CommRawOut(PComVar cv, /*const*/ PCHAR B, int C)
 {
 	int a;
@@ -706,30 +847,32 @@ static BOOL WriteOutBuff(PComVar cv, const char *TempStr, int TempLen)
  */
 static BOOL WriteInBuff(PComVar cv, const char *TempStr, int TempLen)
 {
-	BOOL Full;
+	BYTE *ptr;
+	int len;
 
 	if (TempLen == 0) {
 		return TRUE;
 	}
+	if (cv->InBuff == NULL) {
+		return FALSE;
+	}
 
-	Full = InBuffSize-cv->InBuffCount-TempLen < 0;
-	if (! Full) {
-		memcpy(&(cv->InBuff[cv->InBuffCount]),TempStr,TempLen);
-		cv->InBuffCount = cv->InBuffCount + TempLen;
-		return TRUE;
+	if (cv->InBuffCapacity - InBuffInsertMargin - cv->InBuffCount < TempLen) {
+		return FALSE;
 	}
-	return FALSE;
-}
 
-/**
- *	̓obt@̐擪ɋ󂫂l߂
- */
-static void PackInBuff(PComVar cv)
-{
-	if ( (cv->InPtr>0) && (cv->InBuffCount>0) ) {
-		memmove(cv->InBuff,&(cv->InBuff[cv->InPtr]),cv->InBuffCount);
-		cv->InPtr = 0;
+	// ܂ԂƂ2ɕď
+	while (TempLen > 0) {
+		len = CommInBuffWriteSpan(cv, &ptr);
+		if (len > TempLen) {
+			len = TempLen;
+		}
+		memcpy(ptr, TempStr, len);
+		CommInBuffWriteCommit(cv, len);
+		TempStr += len;
+		TempLen -= len;
 	}
+	return TRUE;
 }
 
 int WINAPI CommBinaryBuffOut(PComVar cv, PCHAR B, int C)
@@ -933,8 +1076,6 @@ int WINAPI CommBinaryEcho(PComVar cv, PCHAR B, int C)
 	if ( ! cv->Ready )
 		return C;
 
-	PackInBuff(cv);
-
 	i = 0;
 	a = 1;
 	while ((a>0) && (i<C)) {
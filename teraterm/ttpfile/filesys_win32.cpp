@@ -44,9 +44,19 @@
 #include "codeconv.h"
 #include "ftlib.h"
 
+// ǂݏ̃obt@TCY
+//	vgRɂĂ1byte ReadFile()/WriteFile() ĂԂ̂ŁA
+//	 Win32 API Ă΂Ȃ悤Aǂݍ݂͐ǂ݁A݂͂܂Ƃ߂ďo
+#define FILEIO_BUF_SIZE (64 * 1024)
+
 typedef struct FileIOWin32 {
 	HANDLE FileHandle;
 	BOOL utf8;
+	// obt@ (OpenRead() ł͐ǂ݁AOpenWrite() ł͏ݗpɎg)
+	unsigned char *buf;	// NULL̂Ƃ̓obt@gȂ
+	size_t buf_len;		// ǂݍݎ: obt@̃f[^, ݎ: oĂȂf[^
+	size_t buf_pos;		// ǂݍݎ: ɕԂf[^̈ʒu
+	BOOL writing;		// TRUE=ݗpɊJĂ
 } TFileIOWin32;
 
 static wc GetFilenameW(TFileIOWin32 *data, const char *filename)
@@ -73,6 +83,10 @@ static BOOL _OpenRead(TFileIO *fv, const char *filename)
 		return FALSE;
 	}
 	data->FileHandle = hFile;
+	data->buf = (unsigned char *)malloc(FILEIO_BUF_SIZE);
+	data->buf_len = 0;
+	data->buf_pos = 0;
+	data->writing = FALSE;
 	return TRUE;
 }
 
@@ -88,13 +102,15 @@ static BOOL _OpenWrite(TFileIO *fv, const char *filename)
 		return FALSE;
 	}
 	data->FileHandle = hFile;
+	data->buf = (unsigned char *)malloc(FILEIO_BUF_SIZE);
+	data->buf_len = 0;
+	data->buf_pos = 0;
+	data->writing = TRUE;
 	return TRUE;
 }
 
-static size_t _ReadFile(TFileIO *fv, void *buf, size_t bytes)
+static size_t ReadFileRaw(HANDLE hFile, void *buf, size_t bytes)
 {
-	TFileIOWin32 *data = (TFileIOWin32 *)fv->data;
-	HANDLE hFile = data->FileHandle;
 	DWORD NumberOfBytesRead;
 	BOOL result = ReadFile(hFile, buf, (UINT)bytes, &NumberOfBytesRead, NULL);
 	assert(result != 0);
@@ -104,10 +120,8 @@ static size_t _ReadFile(TFileIO *fv, void *buf, size_t bytes)
 	return NumberOfBytesRead;
 }
 
-static size_t _WriteFile(TFileIO *fv, const void *buf, size_t bytes)
+static size_t WriteFileRaw(HANDLE hFile, const void *buf, size_t bytes)
 {
-	TFileIOWin32 *data = (TFileIOWin32 *)fv->data;
-	HANDLE hFile = data->FileHandle;
 	DWORD NumberOfBytesWritten;
 	UINT length = (UINT)bytes;
 	BOOL result = WriteFile(hFile, buf, length, &NumberOfBytesWritten, NULL);
@@ -118,13 +132,97 @@ static size_t _WriteFile(TFileIO *fv, const void *buf, size_t bytes)
 	return NumberOfBytesWritten;
 }
 
+/**
+ *	݃obt@ɗ܂Ăf[^o
+ *	@retval	TRUE	ok
+ */
+static BOOL FlushWrite(TFileIOWin32 *data)
+{
+	size_t len = data->buf_len;
+	if (len == 0) {
+		return TRUE;
+	}
+	data->buf_len = 0;
+	return WriteFileRaw(data->FileHandle, data->buf, len) == len;
+}
+
+static size_t _ReadFile(TFileIO *fv, void *buf, size_t bytes)
+{
+	TFileIOWin32 *data = (TFileIOWin32 *)fv->data;
+	HANDLE hFile = data->FileHandle;
+	unsigned char *dst = (unsigned char *)buf;
+	size_t total = 0;
+
+	if (data->buf == NULL) {
+		return ReadFileRaw(hFile, buf, bytes);
+	}
+
+	while (bytes > 0) {
+		size_t len;
+		if (data->buf_pos == data->buf_len) {
+			if (bytes >= FILEIO_BUF_SIZE) {
+				// obt@傫Ƃ͒ړǂݍ
+				return total + ReadFileRaw(hFile, dst, bytes);
+			}
+			// ǂ
+			data->buf_len = ReadFileRaw(hFile, data->buf, FILEIO_BUF_SIZE);
+			data->buf_pos = 0;
+			if (data->buf_len == 0) {
+				// EOF
+				break;
+			}
+		}
+		len = data->buf_len - data->buf_pos;
+		if (len > bytes) {
+			len = bytes;
+		}
+		memcpy(dst, data->buf + data->buf_pos, len);
+		data->buf_pos += len;
+		dst += len;
+		bytes -= len;
+		total += len;
+	}
+	return total;
+}
+
+static size_t _WriteFile(TFileIO *fv, const void *buf, size_t bytes)
+{
+	TFileIOWin32 *data = (TFileIOWin32 *)fv->data;
+	HANDLE hFile = data->FileHandle;
+
+	if (data->buf == NULL) {
+		return WriteFileRaw(hFile, buf, bytes);
+	}
+
+	if (data->buf_len + bytes > FILEIO_BUF_SIZE) {
+		if (!FlushWrite(data)) {
+			return 0;
+		}
+	}
+	if (bytes >= FILEIO_BUF_SIZE) {
+		// obt@傫Ƃ͒ڏo
+		return WriteFileRaw(hFile, buf, bytes);
+	}
+	memcpy(data->buf + data->buf_len, buf, bytes);
+	data->buf_len += bytes;
+	return bytes;
+}
+
 static void _Close(TFileIO *fv)
 {
 	TFileIOWin32 *data = (TFileIOWin32 *)fv->data;
 	if (data->FileHandle != INVALID_HANDLE_VALUE) {
+		if (data->buf != NULL && data->writing) {
+			// ݗpɊJĂAco
+			FlushWrite(data);
+		}
 		CloseHandle(data->FileHandle);
 		data->FileHandle = INVALID_HANDLE_VALUE;
 	}
+	free(data->buf);
+	data->buf = NULL;
+	data->buf_len = 0;
+	data->buf_pos = 0;
 }
 
 /**
@@ -158,6 +256,14 @@ static int Seek(TFileIO *fv, size_t offset)
 	LONG lo = (LONG)((offset >> 0) & 0xffffffff);
 	LONG hi = 0;
 #endif
+	if (data->buf != NULL) {
+		// ݑ҂̃f[^oAǂ݂f[^͎̂Ă
+		if (data->writing) {
+			FlushWrite(data);
+		}
+		data->buf_len = 0;
+		data->buf_pos = 0;
+	}
 	SetFilePointer(data->FileHandle, lo, &hi, 0);
 	if (GetLastError() != 0) {
 		return -1;
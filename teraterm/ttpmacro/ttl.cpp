@@ -95,6 +95,18 @@ static HANDLE DirHandle[NumDirHandle];
 static HANDLE FHandle[NumFHandle];
 static long FPointer[NumFHandle];
 
+// t@Cnh̓ǂݍ݃obt@
+//	fileread/filereadln 1byte ReadFile() Ȃ悤ǂ݂
+//	ǂ݂ĂԁAOS̃t@C|C^͘_IȈʒuɐił̂ŁA
+//	t@C|C^g̑Oɂ HandleSync() Ă
+#define FILEBUF_SIZE (64 * 1024)
+typedef struct {
+	BYTE *buf;		// NULL=m
+	DWORD len;		// obt@̃f[^
+	DWORD pos;		// ɓǂވʒu
+} TFileBuf;
+static TFileBuf FBuf[NumFHandle];
+
 // forward declaration
 static int ExecCmnd(void);
 
@@ -120,6 +132,8 @@ static int HandlePut(HANDLE FH)
 		if (FHandle[i] == INVALID_HANDLE_VALUE) {
 			FHandle[i] = FH;
 			FPointer[i] = 0;
+			FBuf[i].len = 0;
+			FBuf[i].pos = 0;
 			return i;
 		}
 	}
@@ -128,7 +142,7 @@ static int HandlePut(HANDLE FH)
 
 static HANDLE HandleGet(int fhi)
 {
-	if (fhi < 0 || _countof(FHandle) < fhi) {
+	if (fhi < 0 || _countof(FHandle) <= fhi) {
 		return INVALID_HANDLE_VALUE;
 	}
 	return FHandle[fhi];
@@ -136,7 +150,14 @@ static HANDLE HandleGet(int fhi)
 
 static void HandleFree(int fhi)
 {
+	if (fhi < 0 || _countof(FHandle) <= fhi) {
+		return;
+	}
 	FHandle[fhi] = INVALID_HANDLE_VALUE;
+	free(FBuf[fhi].buf);
+	FBuf[fhi].buf = NULL;
+	FBuf[fhi].len = 0;
+	FBuf[fhi].pos = 0;
 }
 
 /**
@@ -183,6 +204,195 @@ static LONG win16_llseek(HANDLE hFile, LONG lOffset, int iOrigin)
 	return pos;
 }
 
+/**
+ *	ǂ݂f[^̂ĂāAOS̃t@C|C^_IȈʒuɖ߂
+ */
+static void HandleSync(int fhi)
+{
+	TFileBuf *fb;
+	if (fhi < 0 || _countof(FHandle) <= fhi) {
+		return;
+	}
+	fb = &FBuf[fhi];
+	if (fb->pos < fb->len) {
+		SetFilePointer(FHandle[fhi], -(LONG)(fb->len - fb->pos), NULL, FILE_CURRENT);
+	}
+	fb->len = 0;
+	fb->pos = 0;
+}
+
+/**
+ *	ǂݍ݃obt@Ƀf[^ȂΓǂݍ
+ *	@retval	FALSE	EOF ܂̓G[
+ */
+static BOOL HandleFill(int fhi)
+{
+	TFileBuf *fb;
+	if (fhi < 0 || _countof(FHandle) <= fhi) {
+		return FALSE;
+	}
+	fb = &FBuf[fhi];
+	if (fb->pos < fb->len) {
+		return TRUE;
+	}
+	if (fb->buf == NULL) {
+		fb->buf = (BYTE *)malloc(FILEBUF_SIZE);
+		if (fb->buf == NULL) {
+			return FALSE;
+		}
+	}
+	fb->pos = 0;
+	fb->len = win16_lread(FHandle[fhi], fb->buf, FILEBUF_SIZE);
+	return fb->len > 0;
+}
+
+/**
+ *	ǂݍ݃obt@gēǂݍ
+ *	@retval ǂݍ݃oCg
+ */
+static UINT HandleRead(int fhi, void *buf, UINT bytes)
+{
+	BYTE *dst = (BYTE *)buf;
+	UINT total = 0;
+	while (total < bytes && HandleFill(fhi)) {
+		TFileBuf *fb = &FBuf[fhi];
+		UINT len = fb->len - fb->pos;
+		if (len > bytes - total) {
+			len = bytes - total;
+		}
+		memcpy(dst + total, fb->buf + fb->pos, len);
+		fb->pos += len;
+		total += len;
+	}
+	return total;
+}
+
+/**
+ *	t@Č݈ʒu猟
+ *	Ƃ͕̌ɁAȂƂ͌̈ʒuɃt@C|C^ړ
+ *
+ *	@retval	TRUE	
+ */
+static BOOL HandleStrSeek(int fhi, const char *Str, size_t Len)
+{
+	HANDLE FH = FHandle[fhi];
+	BYTE *buf;
+	LONG pos;
+	LONG bufpos;	// buf[0] ̃t@Cʒu
+	size_t keep;	// O̓ǂݍ݂cĂf[^
+	size_t len;
+
+	HandleSync(fhi);
+	pos = win16_llseek(FH, 0, 1);
+	if (pos == HFILE_ERROR) {
+		return FALSE;
+	}
+
+	// ǂݍݒPʂ̋Eɂ܂镶T悤A
+	// O̖ Len-1 byte c܂ܑǂݍ
+	buf = (BYTE *)malloc(FILEBUF_SIZE + Len);
+	if (buf == NULL) {
+		return FALSE;
+	}
+	bufpos = pos;
+	keep = 0;
+	for (;;) {
+		const BYTE *p, *end;
+		UINT c = win16_lread(FH, buf + keep, FILEBUF_SIZE);
+		if (c == 0) {
+			break;
+		}
+		len = keep + c;
+		p = buf;
+		end = buf + len;
+		while (p + Len <= end) {
+			p = (const BYTE *)memchr(p, (BYTE)Str[0], end - p - Len + 1);
+			if (p == NULL) {
+				break;
+			}
+			if (memcmp(p, Str, Len) == 0) {
+				win16_llseek(FH, bufpos + (LONG)(p - buf + Len), 0);
+				free(buf);
+				return TRUE;
+			}
+			p++;
+		}
+		keep = (len < Len - 1) ? len : Len - 1;
+		memmove(buf, buf + len - keep, keep);
+		bufpos += (LONG)(len - keep);
+	}
+	free(buf);
+	win16_llseek(FH, pos, 0);
+	return FALSE;
+}
+
+/**
+ *	t@Č݈ʒu擪ɌČ
+ *	݈ʒu1byte͈͂Ɋ܂߂
+ *	Ƃ͕1O(񂪃t@C̐擪̂Ƃ͐擪)A
+ *	ȂƂ͌̈ʒuɃt@C|C^ړ
+ *
+ *	@retval	TRUE	
+ */
+static BOOL HandleStrSeek2(int fhi, const char *Str, size_t Len)
+{
+	HANDLE FH = FHandle[fhi];
+	BYTE *buf;
+	LONG pos;
+	LONG end;		// ͈͂̏I(̈ʒu͊܂܂Ȃ)
+	LONG start;
+
+	HandleSync(fhi);
+	pos = win16_llseek(FH, 0, 1);
+	if (pos == HFILE_ERROR) {
+		return FALSE;
+	}
+	end = win16_llseek(FH, 0, 2);
+	if (end == HFILE_ERROR) {
+		win16_llseek(FH, pos, 0);
+		return FALSE;
+	}
+	if (end > pos + 1) {
+		end = pos + 1;
+	}
+
+	buf = (BYTE *)malloc(FILEBUF_SIZE + Len);
+	if (buf == NULL) {
+		win16_llseek(FH, pos, 0);
+		return FALSE;
+	}
+	//  FILEBUF_SIZE ǂݍށBEɂ܂镶T悤
+	// Len-1 byte d˂ēǂݍ
+	while (end >= (LONG)Len) {
+		LONG len;
+		LONG i;
+		start = end - FILEBUF_SIZE - (LONG)(Len - 1);
+		if (start < 0) {
+			start = 0;
+		}
+		len = end - start;
+		win16_llseek(FH, start, 0);
+		if (win16_lread(FH, buf, len) != (UINT)len) {
+			break;
+		}
+		for (i = len - (LONG)Len; i >= 0; i--) {
+			if (buf[i] == (BYTE)Str[0] && memcmp(&buf[i], Str, Len) == 0) {
+				LONG found = start + i;
+				win16_llseek(FH, (found > 0) ? found - 1 : 0, 0);
+				free(buf);
+				return TRUE;
+			}
+		}
+		if (start == 0) {
+			break;
+		}
+		end = start + (LONG)(Len - 1);
+	}
+	free(buf);
+	win16_llseek(FH, pos, 0);
+	return FALSE;
+}
+
 BOOL InitTTL(HWND HWin)
 {
 	int i;
@@ -1498,6 +1708,7 @@ static WORD TTLFileMarkPtr(void)
 	if ((Err==0) && (GetFirstChar()!=0))
 		Err = ErrSyntax;
 	if (Err!=0) return Err;
+	HandleSync(fhi);
 	pos = win16_llseek(FH,0,1);	 /* mark current pos */
 	if (pos == INVALID_SET_FILE_POINTER) {
 		pos = 0;	// ?
@@ -1636,52 +1847,84 @@ static WORD TTLFileReadln(void)
 	WORD Err;
 	TVarId VarId;
 	int fhi;
-	HANDLE FH;
-	int i, c;
-	TStrVal Str;
+	char *Str;
+	size_t i, len;
 	BOOL EndFile, EndLine;
-	BYTE b;
 
 	Err = 0;
 	GetIntVal(&fhi, &Err);
-	FH = HandleGet(fhi);
 	GetStrVar(&VarId, &Err);
 	if ((Err==0) && (GetFirstChar()!=0))
 		Err = ErrSyntax;
 	if (Err!=0) return Err;
+	if (HandleGet(fhi) == INVALID_HANDLE_VALUE) {
+		// JĂȂt@Cnh̓t@C̏I[ƂĈ
+		SetResult(1);
+		SetStrVal(VarId, "");
+		return Err;
+	}
+
+	// s̒ɐ͂Ȃ̂ŁAKvɉăobt@L
+	len = MaxStrLen;
+	Str = (char *)malloc(len);
+	if (Str == NULL) {
+		return ErrFewMemory;
+	}
 
 	i = 0;
 	EndLine = FALSE;
 	EndFile = TRUE;
-	do {
-		c = win16_lread(FH, &b, 1);
-		if (c>0) EndFile = FALSE;
-		if (c==1) {
-			switch (b) {
-				case 0x0d:
-					c = win16_lread(FH, &b, 1);
-					if ((c==1) && (b!=0x0a))
-						win16_llseek(FH, -1, 1);
-					EndLine = TRUE;
-					break;
-				case 0x0a: EndLine = TRUE; break;
-				default:
-					if (i<MaxStrLen-1)
-					{
-						Str[i] = b;
-						i++;
-					}
+	while (!EndLine && HandleFill(fhi)) {
+		TFileBuf *fb = &FBuf[fhi];
+		const BYTE *start = fb->buf + fb->pos;
+		const BYTE *end = fb->buf + fb->len;
+		const BYTE *p = start;
+		size_t n;
+
+		EndFile = FALSE;
+
+		// obt@ōsT
+		while (p < end && *p != 0x0d && *p != 0x0a) {
+			p++;
+		}
+		n = p - start;
+		if (i + n + 1 > len) {
+			char *s;
+			while (i + n + 1 > len) {
+				len *= 2;
+			}
+			s = (char *)realloc(Str, len);
+			if (s == NULL) {
+				free(Str);
+				return ErrFewMemory;
+			}
+			Str = s;
+		}
+		memcpy(Str + i, start, n);
+		i += n;
+		fb->pos += (DWORD)n;
+
+		if (p < end) {
+			EndLine = TRUE;
+			fb->pos++;
+			if (*p == 0x0d) {
+				// CR LF ̂Ƃ LF ǂݎ̂Ă
+				if (HandleFill(fhi) && fb->buf[fb->pos] == 0x0a) {
+					fb->pos++;
+				}
 			}
 		}
-	} while ((c>=1) && (! EndLine));
+	}
 
 	if (EndFile)
 		SetResult(1);
 	else
 		SetResult(0);
 
+	// ȑOƓAs NUL ΂܂łǂݍ񂾕Ƃ
 	Str[i] = 0;
-	SetStrVal(VarId, Str);
+	SetStrValLen(VarId, Str, strnlen(Str, i));
+	free(Str);
 	return Err;
 }
 
@@ -1695,16 +1938,13 @@ static WORD TTLFileRead(void)
 	WORD Err;
 	TVarId VarId;
 	int fhi;
-	HANDLE FH;
-	int i, c;
+	UINT i;
 	int ReadByte;   // ǂݍރoCg
 	TStrVal Str;
 	BOOL EndFile;
-	BYTE b;
 
 	Err = 0;
 	GetIntVal(&fhi,&Err);
-	FH = HandleGet(fhi);
 	GetIntVal(&ReadByte,&Err);
 	GetStrVar(&VarId,&Err);
 	if ((Err==0) && (GetFirstChar()!=0))
@@ -1712,20 +1952,16 @@ static WORD TTLFileRead(void)
 	if ((Err==0) && (ReadByte < 1 || ReadByte > MaxStrLen-1))  // ͈̓`FbN
 		Err = ErrSyntax;
 	if (Err!=0) return Err;
-
-	EndFile = FALSE;
-	for (i = 0 ; i < ReadByte ; i++) {
-		c = win16_lread(FH,&b,1);
-		if (c <= 0) {  // EOF
-			EndFile = TRUE;
-			break;
-		}
-		if (i<MaxStrLen-1)
-		{
-			Str[i] = b;
-		}
+	if (HandleGet(fhi) == INVALID_HANDLE_VALUE) {
+		// JĂȂt@Cnh̓t@C̏I[ƂĈ
+		SetResult(1);
+		SetStrVal(VarId, "");
+		return Err;
 	}
 
+	i = HandleRead(fhi, Str, ReadByte);
+	EndFile = (i < (UINT)ReadByte);  // EOF
+
 	if (EndFile)
 		SetResult(1);
 	else
@@ -1814,6 +2050,7 @@ static WORD TTLFileSeek(void)
 	if ((Err==0) && (GetFirstChar()!=0))
 		Err = ErrSyntax;
 	if (Err!=0) return Err;
+	HandleSync(fhi);
 	win16_llseek(FH,i,j);
 	return Err;
 }
@@ -1831,6 +2068,7 @@ static WORD TTLFileSeekBack(void)
 		Err = ErrSyntax;
 	if (Err!=0) return Err;
 	/* move back to the marked pos */
+	HandleSync(fhi);
 	win16_llseek(FH,FPointer[fhi],0);
 	return Err;
 }
@@ -1938,44 +2176,21 @@ static WORD TTLFileStrSeek(void)
 {
 	WORD Err;
 	int fhi;
-	HANDLE FH;
-	int Len, i, c;
 	TStrVal Str;
-	BYTE b;
-	long int pos;
 
 	Err = 0;
 	GetIntVal(&fhi,&Err);
-	FH = HandleGet(fhi);
 	GetStrVal(Str,&Err);
 	if ((Err==0) &&
 	    ((strlen(Str)==0) || (GetFirstChar()!=0)))
 		Err = ErrSyntax;
 	if (Err!=0) return Err;
-	pos = win16_llseek(FH,0,1);
-	if (pos == INVALID_SET_FILE_POINTER) return Err;
+	if (HandleGet(fhi) == INVALID_HANDLE_VALUE) return Err;
 
-	Len = strlen(Str);
-	i = 0;
-	do {
-		c = win16_lread(FH,&b,1);
-		if (c==1)
-		{
-			if (b==(BYTE)Str[i])
-				i++;
-			else if (i>0) {
-				i = 0;
-				if (b==(BYTE)Str[0])
-					i = 1;
-			}
-		}
-	} while ((c>=1) && (i!=Len));
-	if (i==Len)
+	if (HandleStrSeek(fhi, Str, strlen(Str)))
 		SetResult(1);
-	else {
+	else
 		SetResult(0);
-		win16_llseek(FH,pos,0);
-	}
 	return Err;
 }
 
@@ -1983,53 +2198,22 @@ static WORD TTLFileStrSeek2(void)
 {
 	WORD Err;
 	int fhi;
-	HANDLE FH;
-	int Len, i, c;
 	TStrVal Str;
-	BYTE b;
-	long int pos, pos2;
-	BOOL Last;
 
 	Err = 0;
 	GetIntVal(&fhi,&Err);
-	FH = HandleGet(fhi);
 	GetStrVal(Str,&Err);
 	if ((Err==0) &&
 	    ((strlen(Str)==0) || (GetFirstChar()!=0)))
 		Err = ErrSyntax;
 	if (Err!=0) return Err;
-	pos = win16_llseek(FH,0,1);
-	if (pos == INVALID_SET_FILE_POINTER) return Err;
+	if (HandleGet(fhi) == INVALID_HANDLE_VALUE) return Err;
 
-	Len = strlen(Str);
-	i = 0;
-	pos2 = pos;
-	do {
-		Last = (pos2<=0);
-		c = win16_lread(FH,&b,1);
-		pos2 = win16_llseek(FH,-2,1);
-		if (c==1)
-		{
-			if (b==(BYTE)Str[Len-1-i])
-				i++;
-			else if (i>0) {
-				i = 0;
-				if (b==(BYTE)Str[Len-1])
-					i = 1;
-			}
-		}
-	} while (!Last && (i!=Len));
-	if (i==Len) {
-		// t@C1oCgڂqbgƁAt@C|C^˂j
-		// INVALID_SET_FILE_POINTER ɂȂ̂ŁA
-		// [ItZbgɂȂ悤ɒB(2008.10.10 yutaka)
-		if (pos2 == INVALID_SET_FILE_POINTER)
-			win16_llseek(FH, 0, 0);
+	// t@C1oCgڂqbgƂ́A[ItZbgɂȂB(2008.10.10 yutaka)
+	if (HandleStrSeek2(fhi, Str, strlen(Str)))
 		SetResult(1);
-	} else {
+	else
 		SetResult(0);
-		win16_llseek(FH,pos,0);
-	}
 	return Err;
 }
 
@@ -2101,6 +2285,7 @@ static WORD TTLFileWrite(BOOL addCRLF)
 	GetIntVal(&fhi, &Err);
 	FH = HandleGet(fhi);
 	if (Err) return Err;
+	HandleSync(fhi);
 
 	P = LinePtr;
 	GetStrVal(Str, &Err);
@@ -4737,16 +4922,20 @@ static WORD TTLStr2Int(void)
 
 static WORD TTLStrCompare(void)
 {
-	TStrVal Str1, Str2;
+	char *Str1, *Str2;
 	WORD Err;
 	int i;
 
 	Err = 0;
-	GetStrVal(Str1,&Err);
-	GetStrVal(Str2,&Err);
+	Str1 = GetStrValAlloc(NULL,&Err);
+	Str2 = GetStrValAlloc(NULL,&Err);
 	if ((Err==0) && (GetFirstChar()!=0))
 		Err = ErrSyntax;
-	if (Err!=0) return Err;
+	if (Err!=0) {
+		free(Str1);
+		free(Str2);
+		return Err;
+	}
 
 	i = strcmp(Str1,Str2);
 	if (i<0)
@@ -4754,6 +4943,8 @@ static WORD TTLStrCompare(void)
 	else if (i>0)
 		i = 1;
 	SetResult(i);
+	free(Str1);
+	free(Str2);
 	return Err;
 }
 
@@ -4761,20 +4952,30 @@ static WORD TTLStrConcat(void)
 {
 	TVarId VarId;
 	WORD Err;
-	TStrVal Str;
+	char *Str;
+	size_t len, srclen;
 
 	Err = 0;
 	GetStrVar(&VarId,&Err);
-	GetStrVal(Str,&Err);
+	Str = GetStrValAlloc(&len,&Err);
 	if ((Err==0) && (GetFirstChar()!=0))
 		Err = ErrSyntax;
-	if (Err!=0) return Err;
+	if (Err!=0) {
+		free(Str);
+		return Err;
+	}
 
-	char dest[MaxStrLen];
-	const char *src = StrVarPtr(VarId);
-	strcpy_s(dest, MaxStrLen, src);
-	strncat_s(dest, MaxStrLen, Str, _TRUNCATE);
-	SetStrVal(VarId, dest);
+	srclen = StrVarLen(VarId);
+	char *dest = (char *)malloc(srclen + len + 1);
+	if (dest == NULL) {
+		free(Str);
+		return ErrFewMemory;
+	}
+	memcpy(dest, StrVarPtr(VarId), srclen);
+	memcpy(dest + srclen, Str, len + 1);
+	SetStrValLen(VarId, dest, srclen + len);
+	free(dest);
+	free(Str);
 	return Err;
 }
 
@@ -4783,39 +4984,43 @@ static WORD TTLStrCopy(void)
 	WORD Err;
 	TVarId VarId;
 	int From, Len, SrcLen;
-	TStrVal Str;
+	char *Str;
+	size_t len;
 
 	Err = 0;
-	GetStrVal(Str,&Err);
+	Str = GetStrValAlloc(&len,&Err);
 	GetIntVal(&From,&Err);
 	GetIntVal(&Len,&Err);
 	GetStrVar(&VarId,&Err);
 	if ((Err==0) && (GetFirstChar()!=0))
 		Err = ErrSyntax;
-	if (Err!=0) return Err;
+	if (Err!=0) {
+		free(Str);
+		return Err;
+	}
 
 	if (From<1) From = 1;
-	SrcLen = strlen(Str)-From+1;
+	SrcLen = (int)len-From+1;
 	if (Len > SrcLen) Len = SrcLen;
 	if (Len < 0) Len = 0;
-	char dest[MaxStrLen];
-	memcpy(dest,&(Str[From-1]),Len);
-	dest[Len] = 0;
-	SetStrVal(VarId, dest);
+	SetStrValLen(VarId, (Len > 0) ? &(Str[From-1]) : "", Len);
+	free(Str);
 	return Err;
 }
 
 static WORD TTLStrLen(void)
 {
 	WORD Err;
-	TStrVal Str;
+	char *Str;
+	size_t len;
 
 	Err = 0;
-	GetStrVal(Str,&Err);
+	Str = GetStrValAlloc(&len,&Err);
+	free(Str);
 	if ((Err==0) && (GetFirstChar()!=0))
 		Err = ErrSyntax;
 	if (Err!=0) return Err;
-	SetResult(strlen(Str));
+	SetResult((int)len);
 	return Err;
 }
 
@@ -4828,17 +5033,24 @@ static WORD TTLStrLen(void)
 static WORD TTLStrMatch(void)
 {
 	WORD Err;
-	TStrVal Str1, Str2;
+	char *Str1, *Str2;
+	size_t len1, len2;
 	int ret, result;
 
 	Err = 0;
-	GetStrVal(Str1,&Err);   // target string
-	GetStrVal(Str2,&Err);   // regex pattern
+	Str1 = GetStrValAlloc(&len1,&Err);   // target string
+	Str2 = GetStrValAlloc(&len2,&Err);   // regex pattern
 	if ((Err==0) && (GetFirstChar()!=0))
 		Err = ErrSyntax;
-	if (Err!=0) return Err;
+	if (Err!=0) {
+		free(Str1);
+		free(Str2);
+		return Err;
+	}
 
-	ret = FindRegexStringOne(Str2, strlen(Str2), Str1, strlen(Str1));
+	ret = FindRegexStringOne(Str2, (int)len2, Str1, (int)len1);
+	free(Str1);
+	free(Str2);
 	if (ret > 0) { // matched
 		result = ret;
 	} else {
@@ -4856,118 +5068,77 @@ static WORD TTLStrMatch(void)
 static WORD TTLStrScan(void)
 {
 	WORD Err;
-	TStrVal Str1, Str2;
+	char *Str1, *Str2;
 
 	Err = 0;
-	GetStrVal(Str1,&Err);
-	GetStrVal(Str2,&Err);
+	Str1 = GetStrValAlloc(NULL,&Err);
+	Str2 = GetStrValAlloc(NULL,&Err);
 	if ((Err==0) && (GetFirstChar()!=0))
 		Err = ErrSyntax;
-	if (Err!=0) return Err;
-
-	if ((Str1[0] == 0) || (Str2[0] == 0)) {
-		SetResult(0);
+	if (Err!=0) {
+		free(Str1);
+		free(Str2);
 		return Err;
 	}
 
-	char *p = strstr(Str1, Str2);
-	if (p != NULL) {
-		SetResult(p - Str1 + 1);
+	if ((Str1[0] == 0) || (Str2[0] == 0)) {
+		SetResult(0);
 	}
 	else {
-		SetResult(0);
+		char *p = strstr(Str1, Str2);
+		if (p != NULL) {
+			SetResult((int)(p - Str1 + 1));
+		}
+		else {
+			SetResult(0);
+		}
 	}
+	free(Str1);
+	free(Str2);
 	return Err;
 }
 
-static void insert_string(char *str, int index, char *addstr)
-{
-	char *np;
-	int srclen;
-	int addlen;
-
-	srclen = strlen(str);
-	addlen = strlen(addstr);
-
-	// ܂͑}ӏȍ~̃f[^AɈړB
-	np = str + (index - 1);
-	memmove_s(np + addlen, MaxStrLen, np, srclen - (index - 1));
-
-	// }
-	memcpy(np, addstr, addlen);
-
-	// null-terminate
-	str[srclen + addlen] = '\0';
-}
-
 static WORD TTLStrInsert(void)
 {
 	WORD Err;
 	TVarId VarId;
 	int Index;
-	TStrVal Str;
-	int srclen, addlen;
-	char *srcptr;
+	char *Str;
+	size_t srclen, addlen;
+	const char *srcptr;
 
 	Err = 0;
 	GetStrVar(&VarId,&Err);
 	GetIntVal(&Index,&Err);
-	GetStrVal(Str,&Err);
+	Str = GetStrValAlloc(&addlen,&Err);
 	if ((Err==0) && (GetFirstChar()!=0))
 		Err = ErrSyntax;
-	if (Err!=0) return Err;
-
-	char dest[MaxStrLen];
-	strcpy_s(dest, sizeof(dest), StrVarPtr(VarId));
-	srcptr = dest;
-	srclen = strlen(srcptr);
-	if (Index <= 0 || Index > srclen+1) {
-		Err = ErrSyntax;
-	}
-	addlen = strlen(Str);
-	if (srclen + addlen + 1 > MaxStrLen) {
-		Err = ErrSyntax;
+	if (Err!=0) {
+		free(Str);
+		return Err;
 	}
-	if (Err!=0) return Err;
-
-	insert_string(srcptr, Index, Str);
-	SetStrVal(VarId, dest);
-
-	return Err;
-}
-
-//  str  index ځi1IWj len 폜
-static void remove_string(char *str, int index, int len)
-{
-	char *np;
-	int srclen, copylen;
-
-	srclen = strlen(str);
 
-	if (len <=0 || index <= 0 || (index-1 + len) > srclen) {
-		return;
+	srcptr = StrVarPtr(VarId);
+	srclen = StrVarLen(VarId);
+	if (Index <= 0 || (size_t)Index > srclen+1) {
+		free(Str);
+		return ErrSyntax;
 	}
 
-	/*
-	   remove_string(str, 6, 4);
-
-	   <------------>srclen
-			 <-->len
-	   XXXXXX****YYY
-	        ^index(np)
-			     ^np+len
-				 <-->srclen - len - index
-		    
-	   XXXXXXYYY
-	 */
-
-	np = str + (index - 1);
-	copylen = srclen - len - (index - 1);
-	if (copylen > 0)
-		memmove_s(np, MaxStrLen, np + len, copylen);
+	char *dest = (char *)malloc(srclen + addlen + 1);
+	if (dest == NULL) {
+		free(Str);
+		return ErrFewMemory;
+	}
+	// index ځi1IWj̑Oɑ}
+	memcpy(dest, srcptr, Index - 1);
+	memcpy(dest + Index - 1, Str, addlen);
+	memcpy(dest + Index - 1 + addlen, srcptr + Index - 1, srclen - (Index - 1) + 1);
+	SetStrValLen(VarId, dest, srclen + addlen);
+	free(dest);
+	free(Str);
 
-	// null-terminate
-	str[srclen - len] = '\0';
+	return Err;
 }
 
 static WORD TTLStrRemove(void)
@@ -4975,8 +5146,8 @@ static WORD TTLStrRemove(void)
 	WORD Err;
 	TVarId VarId;
 	int Index, Len;
-	int srclen;
-	char *srcptr;
+	size_t srclen;
+	const char *srcptr;
 
 	Err = 0;
 	GetStrVar(&VarId,&Err);
@@ -4986,17 +5157,31 @@ static WORD TTLStrRemove(void)
 		Err = ErrSyntax;
 	if (Err!=0) return Err;
 
-	char dest[MaxStrLen];
-	strcpy_s(dest, sizeof(dest), StrVarPtr(VarId));
-	srcptr = dest;
-	srclen = strlen(srcptr);
-	if (Len <=0 || Index <= 0 || (Index-1 + Len) > srclen) {
+	srcptr = StrVarPtr(VarId);
+	srclen = StrVarLen(VarId);
+	if (Len <=0 || Index <= 0 || (size_t)(Index-1 + Len) > srclen) {
 		Err = ErrSyntax;
 	}
 	if (Err!=0) return Err;
 
-	remove_string(srcptr, Index, Len);
-	SetStrVal(VarId, dest);
+	/*
+	   index ځi1IWj len 폜
+
+	   <------------>srclen
+			 <-->len
+	   XXXXXX****YYY
+	        ^index
+		    
+	   XXXXXXYYY
+	 */
+	char *dest = (char *)malloc(srclen - Len + 1);
+	if (dest == NULL) {
+		return ErrFewMemory;
+	}
+	memcpy(dest, srcptr, Index - 1);
+	memcpy(dest + Index - 1, srcptr + Index - 1 + Len, srclen - (Index - 1 + Len) + 1);
+	SetStrValLen(VarId, dest, srclen - Len);
+	free(dest);
 
 	return Err;
 }
@@ -5007,38 +5192,49 @@ static WORD TTLStrReplace(void)
 	TVariableType VarType;
 	TVarId DestVarId;
 	TStrVal oldstr;
-	TStrVal newstr;
-	TStrVal tmpstr;
+	char *newstr;
+	char *tmpstr = NULL;
+	char *dest;
 	char *p;
-	int srclen, oldlen, matchlen;
+	size_t srclen, newlen, matchlen;
+	int oldlen;
 	int pos, ret;
 	int result = 0;
+	TVarId MatchVarId;
 
 	Err = 0;
 	GetStrVar(&DestVarId,&Err);
 	GetIntVal(&pos,&Err);
 	GetStrVal(oldstr,&Err);
-	GetStrVal(newstr,&Err);
+	newstr = GetStrValAlloc(&newlen,&Err);
 	if ((Err==0) && (GetFirstChar()!=0))
 		Err = ErrSyntax;
-	if (Err!=0) return Err;
+	if (Err!=0) {
+		free(newstr);
+		return Err;
+	}
 
-	const char *srcptr = StrVarPtr(DestVarId);
-	srclen = strlen(srcptr);
+	srclen = StrVarLen(DestVarId);
 
-	if (pos > srclen || pos <= 0) {
+	if (pos <= 0 || (size_t)pos > srclen) {
 		result = 0;
 		goto error;
 	}
 	pos--;
 
-	strncpy_s(tmpstr, MaxStrLen, srcptr, _TRUNCATE);
+	//  matchstr ̂ŁARs[Ă
+	tmpstr = (char *)malloc(srclen + 1);
+	if (tmpstr == NULL) {
+		free(newstr);
+		return ErrFewMemory;
+	}
+	memcpy(tmpstr, StrVarPtr(DestVarId), srclen + 1);
 
 	oldlen = strlen(oldstr);
 
 	// strptr pos ڈȍ~ɂāAoldstr TB
 	p = tmpstr + pos;
-	ret = FindRegexStringOne(oldstr, oldlen, p, strlen(p));
+	ret = FindRegexStringOne(oldstr, oldlen, p, (int)(srclen - pos));
 	// FindRegexStringOne̒UnlockVar()Ă܂̂ŁALockVar()ȂB
 	LockVar();
 	if (ret == 0) {
@@ -5053,25 +5249,31 @@ static WORD TTLStrReplace(void)
 	}
 	ret--;
 
-	TVarId MatchVarId;
 	if (CheckVar("matchstr",&VarType,&MatchVarId) &&
 		(VarType==TypString)) {
-		const char *matchptr = StrVarPtr(MatchVarId);
-		matchlen = strlen(matchptr);
+		matchlen = StrVarLen(MatchVarId);
 	} else {
 		result = 0;
 		goto error;
 	}
 
-	char dest[MaxStrLen];
-	strncpy_s(dest, sizeof(dest), tmpstr, pos + ret);
-	strncat_s(dest, sizeof(dest), newstr, _TRUNCATE);
-	strncat_s(dest, sizeof(dest), tmpstr + pos + ret + matchlen, _TRUNCATE);
-	SetStrVal(DestVarId, dest);
+	dest = (char *)malloc(srclen - matchlen + newlen + 1);
+	if (dest == NULL) {
+		free(newstr);
+		free(tmpstr);
+		return ErrFewMemory;
+	}
+	memcpy(dest, tmpstr, pos + ret);
+	memcpy(dest + pos + ret, newstr, newlen);
+	memcpy(dest + pos + ret + newlen, tmpstr + pos + ret + matchlen, srclen - (pos + ret + matchlen) + 1);
+	SetStrValLen(DestVarId, dest, srclen - matchlen + newlen);
+	free(dest);
 
 	result = 1;
 
 error:
+	free(newstr);
+	free(tmpstr);
 	SetResult(result);
 	return Err;
 }
@@ -5114,7 +5316,8 @@ static WORD TTLStrTrim(void)
 	TVarId VarId;
 	int srclen;
 	int i, start, end;
-	char *srcptr, *p;
+	const char *srcptr;
+	const char *p;
 	char table[256];
 
 	Err = 0;
@@ -5125,20 +5328,18 @@ static WORD TTLStrTrim(void)
 		Err = ErrSyntax;
 	if (Err!=0) return Err;
 
-	char dest[MaxStrLen];
-	strcpy_s(dest, sizeof(dest), StrVarPtr(VarId));
-	srcptr = dest;
-	srclen = strlen(srcptr);
+	srcptr = StrVarPtr(VarId);
+	srclen = (int)StrVarLen(VarId);
 
 	// 폜镶̃e[uB
 	memset(table, 0, sizeof(table));
 	for (p = trimchars; *p ; p++) {
-		table[*p] = 1;
+		table[(BYTE)*p] = 1;
 	}
 
 	// ̐擪猟
 	for (i = 0 ; i < srclen ; i++) {
-		if (table[srcptr[i]] == 0)
+		if (table[(BYTE)srcptr[i]] == 0)
 			break;
 	}
 	// 폜ȂLȕ̎n܂B
@@ -5146,38 +5347,34 @@ static WORD TTLStrTrim(void)
 	start = i;
 
 	// ̖猟
-	for (i = srclen - 1 ; i >= 0 ; i--) {
-		if (table[srcptr[i]] == 0)
+	for (i = srclen - 1 ; i >= start ; i--) {
+		if (table[(BYTE)srcptr[i]] == 0)
 			break;
 	}
 	// 폜ȂLȕ̏IB
-	// ׂč폜ΏۂƂȂꍇ́Aend == -1 B
 	end = i;
 
-	// 
-	srcptr[end + 1] = '\0';
-
-	// ɁA擪B
-	remove_string(srcptr, 1, start);
-
-	SetStrVal(VarId, dest);
+	// 擪Ɩ (srcptr  SetStrValLen() ̒ŃRs[)
+	SetStrValLen(VarId, srcptr + start, end + 1 - start);
 	return Err;
 }
 
 static WORD TTLStrSplit(void)
 {
 #define MAXVARNUM 9
-	TStrVal src, delimchars, buf;
+	TStrVal delimchars;
+	char *buf;
+	size_t srclen;
 	WORD Err;
 	int maxvar;
-	int srclen, len;
 	int i, count;
 	BOOL ary = FALSE, omit = FALSE;
 	char *p;
 	char /* *last, */ *tok[MAXVARNUM];
 
 	Err = 0;
-	GetStrVal(src,&Err);
+	/* j󂳂Ă悤ɁARs[obt@gB*/
+	buf = GetStrValAlloc(&srclen,&Err);
 	GetStrVal(delimchars,&Err);
 	// 3rd arg (optional)
 	if (CheckParameterGiven()) {
@@ -5200,18 +5397,15 @@ static WORD TTLStrSplit(void)
 
 	if ((Err==0) && (GetFirstChar()!=0))
 		Err = ErrSyntax;
-	if (Err!=0) return Err;
-
-	if (!ary && (maxvar < 1 || maxvar > MAXVARNUM) )
-		return ErrSyntax;
-
+	if ((Err==0) && !ary && (maxvar < 1 || maxvar > MAXVARNUM) )
+		Err = ErrSyntax;
 	// f~^1݂̂ƂB
-	len = strlen(delimchars);
-	if (len != 1)
-		return ErrSyntax;
-
-	srclen = strlen(src);
-	strcpy_s(buf, MaxStrLen, src);  /* j󂳂Ă悤ɁARs[obt@gB*/
+	if ((Err==0) && (strlen(delimchars) != 1))
+		Err = ErrSyntax;
+	if (Err!=0) {
+		free(buf);
+		return Err;
+	}
 
 #if 0
 	// g[N̐؂osB
@@ -5253,7 +5447,7 @@ static WORD TTLStrSplit(void)
 		p = buf;
 		count = 1;
 		tok[count-1] = p;
-		for (i=0; i < srclen && count < maxvar + omit; i++) { // count ȗɂ́Aߕ̂Ă邽 1 ]ɐi߂
+		for (i=0; (size_t)i < srclen && count < maxvar + omit; i++) { // count ȗɂ́Aߕ̂Ă邽 1 ]ɐi߂
 			if (*p == *delimchars) {
 				*p = '\0';
 				count++;
@@ -5274,6 +5468,7 @@ static WORD TTLStrSplit(void)
 	for (i = count+1 ; i <= MAXVARNUM ; i++) {
 		SetGroupMatchStr(i, "");
 	}
+	free(buf);
 	SetResult(count);
 	return Err;
 #undef MAXVARNUM
@@ -5320,30 +5515,49 @@ static WORD TTLStrJoin(void)
 	if (!ary && (maxvar < 1 || maxvar > MAXVARNUM) )
 		return ErrSyntax;
 
-	char dest[MaxStrLen];
-	strcpy_s(dest, sizeof(dest), StrVarPtr(TargetVarId));
-	srcptr = dest;
+	// ɒ߂ĂA
+	TVarId VarIds[MAXVARNUM];
+	BOOL Found[MAXVARNUM];
+	size_t delimlen = strlen(delimchars);
+	size_t len = 0;
 
-	srcptr[0] = '\0';
 	if (ary) {
 		// TODO array
+		maxvar = 0;
 	}
-	else {
-		for (i = 0 ; i < maxvar ; i++) {
-			TVarId VarId;
-			_snprintf_s(buf, sizeof(buf), _TRUNCATE, "groupmatchstr%d", i + 1);
-			if (CheckVar(buf,&VarType,&VarId)) {
-				if (VarType!=TypString)
-					return ErrSyntax;
-				p = StrVarPtr(VarId);
-				strncat_s(srcptr, MaxStrLen, p, _TRUNCATE);
-				if (i < maxvar-1) {
-					strncat_s(srcptr, MaxStrLen, delimchars, _TRUNCATE);
-				}
+	for (i = 0 ; i < maxvar ; i++) {
+		_snprintf_s(buf, sizeof(buf), _TRUNCATE, "groupmatchstr%d", i + 1);
+		Found[i] = CheckVar(buf,&VarType,&VarIds[i]);
+		if (Found[i]) {
+			if (VarType!=TypString)
+				return ErrSyntax;
+			len += StrVarLen(VarIds[i]);
+			if (i < maxvar-1) {
+				len += delimlen;
 			}
 		}
 	}
-	SetStrVal(TargetVarId, dest);
+
+	char *dest = (char *)malloc(len + 1);
+	if (dest == NULL) {
+		return ErrFewMemory;
+	}
+	srcptr = dest;
+	for (i = 0 ; i < maxvar ; i++) {
+		if (Found[i]) {
+			size_t l = StrVarLen(VarIds[i]);
+			p = StrVarPtr(VarIds[i]);
+			memcpy(srcptr, p, l);
+			srcptr += l;
+			if (i < maxvar-1) {
+				memcpy(srcptr, delimchars, delimlen);
+				srcptr += delimlen;
+			}
+		}
+	}
+	*srcptr = '\0';
+	SetStrValLen(TargetVarId, dest, len);
+	free(dest);
 
 	return Err;
 #undef MAXVARNUM
@@ -5369,15 +5583,19 @@ static WORD TTLToLower(void)
 {
 	WORD Err;
 	TVarId VarId;
-	TStrVal Str;
+	char *Str;
+	size_t len;
 	int i=0;
 
 	Err = 0;
 	GetStrVar(&VarId,&Err);
-	GetStrVal(Str,&Err);
+	Str = GetStrValAlloc(&len,&Err);
 	if ((Err==0) && (GetFirstChar()!=0))
 		Err = ErrSyntax;
-	if (Err!=0) return Err;
+	if (Err!=0) {
+		free(Str);
+		return Err;
+	}
 
 	while (Str[i] != 0) {
 		if (Str[i] >= 'A' && Str[i] <= 'Z') {
@@ -5386,7 +5604,8 @@ static WORD TTLToLower(void)
 		i++;
 	}
 
-	SetStrVal(VarId, Str);
+	SetStrValLen(VarId, Str, len);
+	free(Str);
 	return Err;
 }
 
@@ -5395,15 +5614,19 @@ static WORD TTLToUpper(void)
 {
 	WORD Err;
 	TVarId VarId;
-	TStrVal Str;
+	char *Str;
+	size_t len;
 	int i=0;
 
 	Err = 0;
 	GetStrVar(&VarId,&Err);
-	GetStrVal(Str,&Err);
+	Str = GetStrValAlloc(&len,&Err);
 	if ((Err==0) && (GetFirstChar()!=0))
 		Err = ErrSyntax;
-	if (Err!=0) return Err;
+	if (Err!=0) {
+		free(Str);
+		return Err;
+	}
 
 	while (Str[i] != 0) {
 		if (Str[i] >= 'a' && Str[i] <= 'z') {
@@ -5412,7 +5635,8 @@ static WORD TTLToUpper(void)
 		i++;
 	}
 
-	SetStrVal(VarId, Str);
+	SetStrValLen(VarId, Str, len);
+	free(Str);
 	return Err;
 }
 
@@ -5464,7 +5688,8 @@ static WORD TTLWait(BOOL Ln)
 
 	ClearWait();
 
-	for (i=0; i<10; i++) {
+	// ҂󂯂镶̐ɐ͂Ȃ
+	for (i=0; ; i++) {
 		Err = 0;
 		if (GetString(Str, &Err)) {
 			SetWait(i+1, Str);
@@ -5847,6 +6072,49 @@ static WORD TTLScpRecv(void)
 	return SendCmnd(CmdScpRcv, 0);
 }
 
+// SYNOPSIS:
+//   sftpsend "c:\usr\sample.chm" "doc/sample.chm"
+//   sftpsend "c:\usr\sample.chm" "doc/sample.chm" 1   (rĊJ)
+//   sftprecv "src/foo.txt" "c:\foo.txt"
+//   sftprecv "src/foo.txt" "c:\foo.txt" 1
+static WORD TTLSftpTransfer(char OpId)
+{
+	TStrVal Str;
+	TStrVal Str2;
+	int Resume;
+	WORD Err;
+
+	Err = 0;
+	GetStrVal(Str,&Err);
+
+	if ((Err==0) &&
+	    ((strlen(Str)==0)))
+		Err = ErrSyntax;
+	if (Err!=0) return Err;
+
+	GetStrVal(Str2,&Err);
+	if (Err) {
+		Str2[0] = '\0';
+		Err = 0;
+	}
+
+	Resume = 0;
+	if (CheckParameterGiven()) {
+		GetIntVal(&Resume,&Err);
+	}
+
+	if ((Err==0) && (GetFirstChar() != 0))
+		Err = ErrSyntax;
+	if (Err!=0) return Err;
+
+	SetFile(Str);
+	SetSecondFile(Str2);
+	SetSftpOption(Resume);
+	// ]n߂ȂƂ 0 ̂܂
+	SetResult(0);
+	return SendCmnd(OpId, IdTTLWaitCmndResult);
+}
+
 #if defined(OUTPUTDEBUGSTRING_ENABLE)
 static WORD TTLOutputDebugstring(void)
 {
@@ -6224,6 +6492,10 @@ static int ExecCmnd(void)
 			Err = TTLScpSend(); break;      // add 'scpsend' (2008.1.1 yutaka)
 		case RsvScpRecv:
 			Err = TTLScpRecv(); break;      // add 'scprecv' (2008.1.4 yutaka)
+		case RsvSftpSend:
+			Err = TTLSftpTransfer(CmdSftpSend); break;
+		case RsvSftpRecv:
+			Err = TTLSftpTransfer(CmdSftpRcv); break;
 		case RsvSend:
 			Err = TTLSend(); break;
 		case RsvSendText:
@@ -6411,7 +6683,7 @@ static int ExecCmnd(void)
 							if (StrConst)
 								SetStrVal(VarId,Str);
 							else {
-								SetStrVal(VarId, StrVarPtr((TVarId)Val));
+								CopyStrVar(VarId, (TVarId)Val);
 							}
 						break;
 						default:
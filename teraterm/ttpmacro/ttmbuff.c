@@ -60,9 +60,19 @@ static BINT BuffLen[MAXNESTLEVEL];
 static BINT BuffPtr[MAXNESTLEVEL];
 
 // sz
-#define MAX_LINENO 100000
-static BINT *BuffLineNo[MAXNESTLEVEL];
-static BINT BuffLineNoMaxIndex[MAXNESTLEVEL];
+//	t@CǂݍݎɈxsɕĂAs
+//	obt@1byteɍso
+typedef struct {
+	BINT Start;		// s̐擪
+	BINT Len;		// s̒(s̐䕶܂܂Ȃ)
+	BINT Next;		// ̍s̐擪
+	int LineNo;		// sԍ
+} TLineInfo;
+
+static TLineInfo *BuffLines[MAXNESTLEVEL];
+static int BuffLineCount[MAXNESTLEVEL];
+static int BuffLineIndex[MAXNESTLEVEL];		// ɓǂލs̃CfbNX(qg)
+static int BuffEndLineNo[MAXNESTLEVEL];		// obt@I[̍sԍ
 
 #define MAXSP 10
 
@@ -123,6 +133,102 @@ int IsUpdateMacroCommand(void)
 }
 
 
+/**
+ *	obt@sɕčsz
+ *	GetRawLine() ƓKŕ
+ *	(s̐䕶(^uȊO)́AAs܂߂ēǂݔ΂)
+ */
+static BOOL MakeLineInfo(int IBuff)
+{
+	const BYTE *buf = (BYTE *)Buff[IBuff];
+	BINT len = BuffLen[IBuff];
+	BINT ptr = 0;
+	int count = 0;
+	int max = 0;
+	int lineno = 1;
+	TLineInfo *lines = NULL;
+
+	do {
+		TLineInfo *line;
+		if (count == max) {
+			TLineInfo *p;
+			max = (max == 0) ? 256 : max * 2;
+			p = (TLineInfo *)realloc(lines, sizeof(TLineInfo) * max);
+			if (p == NULL) {
+				free(lines);
+				return FALSE;
+			}
+			lines = p;
+		}
+		line = &lines[count];
+		line->Start = ptr;
+		while ((ptr < len) && ((buf[ptr] >= 0x20) || (buf[ptr] == 0x09))) {
+			ptr++;
+		}
+		line->Len = ptr - line->Start;
+		line->LineNo = lineno;
+		while ((ptr < len) && (buf[ptr] < 0x20) && (buf[ptr] != 0x09)) {
+			// obt@̍ŌオsR[hꍇA̍sԍ݂͑ȂB
+			if (buf[ptr] == 0x0A && ptr != len - 1) {
+				lineno++;
+			}
+			ptr++;
+		}
+		line->Next = ptr;
+		count++;
+	} while (ptr < len);
+
+	BuffLines[IBuff] = lines;
+	BuffLineCount[IBuff] = count;
+	BuffLineIndex[IBuff] = 0;
+	BuffEndLineNo[IBuff] = lineno;
+	return TRUE;
+}
+
+/**
+ *	obt@ʒusT
+ *	@param[out]	Err		Ptr s̐擪wĂȂƂ ErrInvalidCtl
+ *	@retval	NULL	obt@̏I[A܂ Ptr s̐擪wĂȂ
+ */
+static const TLineInfo *FindLine(int IBuff, BINT Ptr, WORD *Err)
+{
+	const TLineInfo *lines = BuffLines[IBuff];
+	int index = BuffLineIndex[IBuff];
+	int lo, hi;
+
+	*Err = 0;
+	if (Ptr >= BuffLen[IBuff] && Ptr > 0) {
+		return NULL;
+	}
+
+	// قƂǂ̏ꍇ͎̍sǂ
+	if (index < BuffLineCount[IBuff] && lines[index].Start == Ptr) {
+		BuffLineIndex[IBuff] = index + 1;
+		return &lines[index];
+	}
+
+	// WvƂ͓񕪒T
+	lo = 0;
+	hi = BuffLineCount[IBuff] - 1;
+	while (lo <= hi) {
+		int mid = (lo + hi) / 2;
+		if (lines[mid].Start < Ptr) {
+			lo = mid + 1;
+		}
+		else if (lines[mid].Start > Ptr) {
+			hi = mid - 1;
+		}
+		else {
+			BuffLineIndex[IBuff] = mid + 1;
+			return &lines[mid];
+		}
+	}
+
+	// x߂͍s̐擪Ȃ̂ŁAs̓rwĂ邱Ƃ͂Ȃ͂
+	*Err = ErrInvalidCtl;
+	return NULL;
+}
+
 static BOOL LoadMacroFile(const wchar_t *FileName, int IBuff)
 {
 	wchar_t basename[MAX_PATH];
@@ -154,34 +260,12 @@ static BOOL LoadMacroFile(const wchar_t *FileName, int IBuff)
 	}
 	BuffLen[IBuff] = Len;
 
-	// sԍzBɂAobt@̃CfbNXsԍւ̕ϊ
-	// O(N)->O(logN)Ōł悤ɂȂB
-	// (2014.1.18 yutaka)
-	{
-		unsigned int i, n;
-		n = 0;
-		if (BuffLineNo[IBuff] == NULL) {
-			BuffLineNo[IBuff] = malloc(MAX_LINENO * sizeof(BINT));
-		}
-		BuffLineNo[IBuff][n] = 0;
-		for (i = 0 ; i < BuffLen[IBuff] ; i++) {
-			if (Buff[IBuff][i] == 0x0A) {
-				if (i == BuffLen[IBuff] - 1) {
-					// obt@̍ŌオsR[hꍇA̍sԍ݂͑ȂB
-
-				} else {
-					if (n < MAX_LINENO - 1) {
-						n++;
-						BuffLineNo[IBuff][n] = i + 1;
-					} else {
-						// Out of memory
-
-					}
-				}
-			}
-		}
-
-		BuffLineNoMaxIndex[IBuff] = n + 1;
+	// szBɂAsɍsoƂ
+	// obt@̃CfbNXsԍƂɃobt@𑖍ȂĂ悭ȂB
+	free(BuffLines[IBuff]);
+	BuffLines[IBuff] = NULL;
+	if (! MakeLineInfo(IBuff)) {
+		return FALSE;
 	}
 
 	return TRUE;
@@ -198,74 +282,49 @@ const char *GetMacroFileName(void)
 }
 
 
-// ݎs̃}Nt@C̍sԍԂ (2005.7.18 yutaka)
-static int getCurrentLineNumber(BINT curpos, BINT *lineno, BINT linenomax)
-{
-	BINT i, no;
-
-	no = 0;
-	for (i = 0 ; i < linenomax ; i++) {
-		if (curpos < lineno[i]) {
-			no = i;
-			break;
-		}
-	}
-	// Ō̍sp[XہAsԍԂĂȂCB
-	// (2014.7.6 yutaka)
-	if (no == 0 && i == linenomax) {
-		no = linenomax;
-	}
-
-	return (no);
-}
-
-
 BOOL GetRawLine()
 {
-	int i;
-	BYTE b;
+	const TLineInfo *line;
+	BINT len;
+	WORD Err;
 
 	LineStart = BuffPtr[INest];
 	if (Buff[INest]==NULL) return FALSE;
 
-	if (BuffPtr[INest]<BuffLen[INest])
-		b = (Buff[INest])[BuffPtr[INest]];
-
-	i = 0;
-	memset(LineBuff, 0, sizeof(LineBuff));
-	while ((BuffPtr[INest]<BuffLen[INest]) &&
-		((b>=0x20) || (b==0x09)))
-	{
-		// LineBuff[]̃obt@TCY𒴂ꍇ̓G[ƂB
-		// A}NȂÎŃ_CAO\悤ɂق
-		// ȂB
-		// (2007.6.6 yutaka)
-		// obt@TCYɎ܂͈͂ŃRs[B
-		// break Ƃӂꂽ̍sƂĈ̂ break ȂB
-		// (2007.6.9 maya)
-		if (i < MaxLineLen-1) {
-			LineBuff[i] = b;
-		}
-		i++;
-		BuffPtr[INest]++;
-		if (BuffPtr[INest]<BuffLen[INest])
-			b = (Buff[INest])[BuffPtr[INest]];
-	}
 	LinePtr = 0;
-	LineLen = (WORD)strlen(LineBuff);
 	LineParsePtr = 0;
 
-	// current line number (2005.7.18 yutaka)
-	// obt@̃CfbNX獂ɍsԍ悤ɂB(2014.1.18 yutaka)
-	LineNo = getCurrentLineNumber(BuffPtr[INest], BuffLineNo[INest], BuffLineNoMaxIndex[INest]);
+	line = FindLine(INest, BuffPtr[INest], &Err);
+	if (Err != 0) {
+		// sʒuĂ̂ŁÃobt@̎sł؂
+		memset(LineBuff, 0, sizeof(LineBuff));
+		LineLen = 0;
+		DispErr(Err);
+		BuffPtr[INest] = BuffLen[INest];
+		return FALSE;
+	}
+	if (line == NULL) {
+		// obt@̏I[
+		memset(LineBuff, 0, sizeof(LineBuff));
+		LineLen = 0;
+		LineNo = BuffEndLineNo[INest];
+		return FALSE;
+	}
 
-	while ((BuffPtr[INest]<BuffLen[INest]) &&
-		(b<0x20) && (b!=0x09))
-	{
-		BuffPtr[INest]++;
-		if (BuffPtr[INest]<BuffLen[INest])
-			b = (Buff[INest])[BuffPtr[INest]];
+	// LineBuff[]̃obt@TCY𒴂ꍇ́Aobt@TCYɎ܂͈͂ŃRs[B
+	// (2007.6.9 maya)
+	len = line->Len;
+	if (len > MaxLineLen-1) {
+		len = MaxLineLen-1;
 	}
+	memcpy(LineBuff, &(Buff[INest])[line->Start], len);
+	memset(&LineBuff[len], 0, sizeof(LineBuff) - len);
+	LineLen = (WORD)len;
+
+	// current line number (2005.7.18 yutaka)
+	LineNo = line->LineNo;
+
+	BuffPtr[INest] = line->Next;
 	return ((LineLen>0) || (BuffPtr[INest]<BuffLen[INest]));
 }
 
@@ -377,12 +436,13 @@ void CloseBuff(int IBuff)
 
 	DelLabVar((WORD)IBuff);
 	for (i=IBuff ; i<=MAXNESTLEVEL-1 ; i++) {
-		free(BuffLineNo[i]);
+		free(BuffLines[i]);
 		/* |C^̏RCB4.81ł̃fO[hB
 		 * (2014.3.4 yutaka)
 		 */
-		BuffLineNo[i] = NULL;
-		BuffLineNoMaxIndex[i] = 0;
+		BuffLines[i] = NULL;
+		BuffLineCount[i] = 0;
+		BuffLineIndex[i] = 0;
 	}
 
 	while ((SP>0) && (LevelStack[SP-1]>=IBuff)) {
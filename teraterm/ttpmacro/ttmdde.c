@@ -96,9 +96,32 @@ static int RBufPtr = 0;
 static int RBufCount = 0;
 
   // for 'Wait' command
-static PCHAR PWaitStr[10];
-static int WaitStrLen[10];
-static int WaitCount[10];
+typedef struct {
+	char *Str;			// NULL=ݒ
+	int Len;
+	regex_t *Reg;		// waitregex pɃRpCK\
+	BOOL RegError;		// K\̃RpCɎs
+} TWaitStr;
+static TWaitStr *WaitStrs;
+static int WaitStrNum;		// WaitStrs[] ̗vf
+
+// ҂󂯂镶 Aho-Corasick @̃I[g}gɂ܂Ƃ߂ĂA
+// M1byteƂɏԑJڂ邾őSp^[ƍ
+typedef struct {
+	int Child;		// ŏ̎qm[h, 0=Ȃ
+	int Next;		// ̌Zm[h, 0=Ȃ
+	int Fail;		// vȂƂ̑Jڐ
+	int Out;		// ̃m[hňvp^[̔ԍ(1`), 0=Ȃ
+					// fail ňv̂܂߁Aԍł
+	BYTE c;
+} TWaitNode;
+static TWaitNode *WaitNodes;		// [0]̓[g
+static int WaitNodeNum;
+static int WaitRoot[256];			// [g̑J
+static BOOL WaitDirty = TRUE;		// p^[ς̂ŃI[g}g蒼
+static int WaitState;				// wait ݂̌̏
+static int Wait4allState[MAXNWIN];	// wait4all ̃obt@Ƃ̏
+static int RegexCheckedLen = -1;	// K\ŏƍς݂ RecvLnBuff ̒
   // for "WaitRecv" command
 static TStrVal Wait2SubStr;
 static int Wait2Count, Wait2Len;
@@ -252,7 +275,6 @@ void Word2HexStr(WORD w, LPSTR HexStr)
 
 BOOL InitDDE(HWND HWin)
 {
-	int i;
 	WORD w;
 	char Cmd[10];
 
@@ -264,11 +286,7 @@ BOOL InitDDE(HWND HWin)
 	RBufPtr = 0;
 	RBufCount = 0;
 	QuoteFlag = FALSE;
-	for (i = 0 ; i<=9 ; i++) {
-		PWaitStr[i] = NULL;
-		WaitStrLen[i] = 0;
-		WaitCount[i] = 0;
-	}
+	ClearWait();
 
 	if (DdeInitialize(&Inst, DdeCallbackProc,
 	                  APPCMD_CLIENTONLY |
@@ -460,6 +478,7 @@ void ClearRecvLnBuff()
 {
 	RecvLnPtr = 0;
 	RecvLnLast = 0;
+	RegexCheckedLen = -1;
 }
 
 void PutRecvLnBuff(BYTE b)
@@ -499,14 +518,22 @@ void FlushRecv()
 void ClearWait()
 {
 	int i;
+	BOOL reg = FALSE;
 
-	for (i = 0 ; i <= 9 ; i++) {
-		if (PWaitStr[i]!=NULL) {
-			free(PWaitStr[i]);
+	for (i = 0 ; i < WaitStrNum ; i++) {
+		free(WaitStrs[i].Str);
+		if (WaitStrs[i].Reg != NULL) {
+			onig_free(WaitStrs[i].Reg);
+			reg = TRUE;
 		}
-		PWaitStr[i] = NULL;
-		WaitStrLen[i] = 0;
-		WaitCount[i] = 0;
+	}
+	free(WaitStrs);
+	WaitStrs = NULL;
+	WaitStrNum = 0;
+	WaitDirty = TRUE;
+	RegexCheckedLen = -1;
+	if (reg) {
+		onig_end();
 	}
 
 	RegexActionType = REGEX_NONE; // regex disabled
@@ -514,17 +541,38 @@ void ClearWait()
 
 void SetWait(int Index, const char *Str)
 {
-	if (PWaitStr[Index-1])
-		free(PWaitStr[Index-1]);
+	TWaitStr *w;
+
+	if (Index < 1) {
+		return;
+	}
+	if (Index > WaitStrNum) {
+		TWaitStr *p = (TWaitStr *)realloc(WaitStrs, sizeof(TWaitStr) * Index);
+		if (p == NULL) {
+			return;
+		}
+		memset(&p[WaitStrNum], 0, sizeof(TWaitStr) * (Index - WaitStrNum));
+		WaitStrs = p;
+		WaitStrNum = Index;
+	}
+
+	w = &WaitStrs[Index-1];
+	free(w->Str);
+	if (w->Reg != NULL) {
+		onig_free(w->Reg);
+		w->Reg = NULL;
+	}
+	w->RegError = FALSE;
 
-	PWaitStr[Index-1] = _strdup(Str);
+	w->Str = _strdup(Str);
 
-	if (PWaitStr[Index-1])
-		WaitStrLen[Index-1] = strlen(Str);
+	if (w->Str)
+		w->Len = strlen(Str);
 	else
-		WaitStrLen[Index-1] = 0;
+		w->Len = 0;
 
-	WaitCount[Index-1] = 0;
+	WaitDirty = TRUE;
+	RegexCheckedLen = -1;
 }
 
 void SetRecvLnClear(BOOL v)
@@ -546,12 +594,128 @@ void SetWaitN(int Len)
 
 int CmpWait(int Index, PCHAR Str)
 {
-	if (PWaitStr[Index-1]!=NULL) {
-		return strcmp(PWaitStr[Index-1],Str);
+	if (Index >= 1 && Index <= WaitStrNum && WaitStrs[Index-1].Str!=NULL) {
+		return strcmp(WaitStrs[Index-1].Str,Str);
 	}
 	return 1;
 }
 
+// ԍ̏قԂ (0 ͂Ȃ)
+static int MinOut(int a, int b)
+{
+	if (a == 0) return b;
+	if (b == 0) return a;
+	return (a < b) ? a : b;
+}
+
+/**
+ *	 s  b MƂ̑Jڐ
+ */
+static int WaitNext(int s, BYTE b)
+{
+	for (;;) {
+		int c;
+		if (s == 0) {
+			return WaitRoot[b];
+		}
+		for (c = WaitNodes[s].Child; c != 0; c = WaitNodes[c].Next) {
+			if (WaitNodes[c].c == b) {
+				return c;
+			}
+		}
+		s = WaitNodes[s].Fail;
+	}
+}
+
+/**
+ *	҂󂯂镶񂩂I[g}g
+ */
+static void WaitBuild(void)
+{
+	int i, max, head, tail, c;
+	int *queue;
+
+	free(WaitNodes);
+	WaitNodes = NULL;
+	WaitNodeNum = 0;
+	WaitState = 0;
+	memset(Wait4allState, 0, sizeof(Wait4allState));
+	memset(WaitRoot, 0, sizeof(WaitRoot));
+	WaitDirty = FALSE;
+
+	max = 1;
+	for (i = 0 ; i < WaitStrNum ; i++) {
+		max += WaitStrs[i].Len;
+	}
+	WaitNodes = (TWaitNode *)calloc(max, sizeof(TWaitNode));
+	queue = (int *)malloc(sizeof(int) * max);
+	if (WaitNodes == NULL || queue == NULL) {
+		free(WaitNodes);
+		WaitNodes = NULL;
+		free(queue);
+		return;
+	}
+	WaitNodeNum = 1;
+
+	// gC؂
+	for (i = 0 ; i < WaitStrNum ; i++) {
+		const BYTE *p = (const BYTE *)WaitStrs[i].Str;
+		int j, s = 0;
+		if (p == NULL) {
+			continue;
+		}
+		for (j = 0 ; j < WaitStrs[i].Len ; j++) {
+			for (c = WaitNodes[s].Child; c != 0; c = WaitNodes[c].Next) {
+				if (WaitNodes[c].c == p[j]) {
+					break;
+				}
+			}
+			if (c == 0) {
+				c = WaitNodeNum++;
+				WaitNodes[c].c = p[j];
+				WaitNodes[c].Next = WaitNodes[s].Child;
+				WaitNodes[s].Child = c;
+			}
+			s = c;
+		}
+		// 񂪕Ƃ͔ԍ̏قD悷
+		WaitNodes[s].Out = MinOut(WaitNodes[s].Out, i + 1);
+	}
+
+	// D fail ߂
+	head = tail = 0;
+	for (c = WaitNodes[0].Child; c != 0; c = WaitNodes[c].Next) {
+		WaitRoot[WaitNodes[c].c] = c;
+		WaitNodes[c].Fail = 0;
+		WaitNodes[c].Out = MinOut(WaitNodes[c].Out, WaitNodes[0].Out);
+		queue[tail++] = c;
+	}
+	while (head < tail) {
+		int s = queue[head++];
+		for (c = WaitNodes[s].Child; c != 0; c = WaitNodes[c].Next) {
+			int f = WaitNext(WaitNodes[s].Fail, WaitNodes[c].c);
+			WaitNodes[c].Fail = f;
+			WaitNodes[c].Out = MinOut(WaitNodes[c].Out, WaitNodes[f].Out);
+			queue[tail++] = c;
+		}
+	}
+	free(queue);
+}
+
+/**
+ *	1byte MƂ̏ԑJ
+ *	@param[in,out]	state	
+ *	@return	vp^[̔ԍ(1`), 0=vȂ
+ */
+static int WaitMatch(int *state, BYTE b)
+{
+	if (WaitNodes == NULL) {
+		return 0;
+	}
+	*state = WaitNext(*state, b);
+	return WaitNodes[*state].Out;
+}
+
 void SetWait2(PCHAR Str, int Len, int Pos)
 {
 	strncpy_s(Wait2SubStr, sizeof(Wait2SubStr),Str, _TRUNCATE);
@@ -587,23 +751,15 @@ void SetWait2(PCHAR Str, int Len, int Pos)
 }
 
 
-// K\ɂp^[}b`siOnigurumagpj
+// K\RpC
 //
-// return : }b`ʒui1IWj
-//         0: }b`Ȃ
-int FindRegexStringOne(char *regex, int regex_len, char *target, int target_len)
+// return NULL: G[
+static regex_t *RegexCompile(char *regex, int regex_len)
 {
 	int r;
-	unsigned char *start, *range, *end;
 	regex_t* reg;
 	OnigErrorInfo einfo;
-	OnigRegion *region;
 	UChar* pattern = (UChar* )regex;
-	UChar* str     = (UChar* )target;
-	int matched = 0;
-	char ch;
-	int mstart, mend;
-
 
 	r = onig_new(&reg, pattern, pattern + regex_len,
 		RegexOpt, RegexEnc, RegexSyntax, &einfo);
@@ -611,8 +767,25 @@ int FindRegexStringOne(char *regex, int regex_len, char *target, int target_len)
 		char s[ONIG_MAX_ERROR_MESSAGE_LEN];
 		onig_error_code_to_str(s, r, &einfo);
 		fprintf(stderr, "ERROR: %s\n", s);
-		return -1;
+		return NULL;
 	}
+	return reg;
+}
+
+// RpCς݂̐K\ŌA}b` matchstr, groupmatchstr[1-9] ֊i[
+//
+// return : }b`ʒui1IWj
+//         0: }b`Ȃ
+//        -1: G[
+static int RegexSearch(regex_t* reg, char *target, int target_len)
+{
+	int r;
+	unsigned char *start, *range, *end;
+	OnigRegion *region;
+	UChar* str     = (UChar* )target;
+	int matched = 0;
+	char ch;
+	int mstart, mend;
 
 	region = onig_region_new();
 
@@ -664,10 +837,30 @@ int FindRegexStringOne(char *regex, int regex_len, char *target, int target_len)
 		char s[ONIG_MAX_ERROR_MESSAGE_LEN];
 		onig_error_code_to_str(s, r);
 		fprintf(stderr, "ERROR: %s\n", s);
-		return -1;
+		matched = -1;
 	}
 
 	onig_region_free(region, 1 /* 1:free self, 0:free contents only */);
+
+	return (matched);
+}
+
+// K\ɂp^[}b`siOnigurumagpj
+//
+// return : }b`ʒui1IWj
+//         0: }b`Ȃ
+int FindRegexStringOne(char *regex, int regex_len, char *target, int target_len)
+{
+	regex_t* reg;
+	int matched;
+
+	reg = RegexCompile(regex, regex_len);
+	if (reg == NULL) {
+		return -1;
+	}
+
+	matched = RegexSearch(reg, target, target_len);
+
 	onig_free(reg);
 	onig_end();
 
@@ -685,8 +878,23 @@ int FindRegexString(void)
 	if (RecvLnPtr == 0)
 		return 0;  // not match
 
-	for (i = 0 ; i < 10 ; i++) {
-		if (PWaitStr[i] && FindRegexStringOne(PWaitStr[i], WaitStrLen[i], RecvLnBuff, RecvLnPtr) > 0) { // matched
+	// OƍƂMf[^ĂȂ΁AƍȂĂʂ͓
+	if (RecvLnPtr == RegexCheckedLen)
+		return 0;  // not match
+
+	for (i = 0 ; i < WaitStrNum ; i++) {
+		TWaitStr *w = &WaitStrs[i];
+		if (w->Str == NULL) {
+			continue;
+		}
+		// K\͍ŏɎgƂɈxRpC
+		if (w->Reg == NULL && !w->RegError) {
+			w->Reg = RegexCompile(w->Str, w->Len);
+			if (w->Reg == NULL) {
+				w->RegError = TRUE;
+			}
+		}
+		if (w->Reg != NULL && RegexSearch(w->Reg, RecvLnBuff, RecvLnPtr) > 0) { // matched
 			// }b`s inputstr ֊i[
 			LockVar();
 			SetInputStr(GetRecvLnBuff());  // Ńobt@NA
@@ -695,6 +903,7 @@ int FindRegexString(void)
 			return i+1;
 		}
 	}
+	RegexCheckedLen = RecvLnPtr;
 
 	return 0;
 }
@@ -710,8 +919,11 @@ int FindRegexString(void)
 int Wait()
 {
 	BYTE b;
-	int i, j, Found, ret;
-	PCHAR Str;
+	int Found, ret;
+
+	if (WaitDirty) {
+		WaitBuild();
+	}
 
 	Found = 0;
 	while ((Found==0) && Read1Byte(&b))
@@ -727,32 +939,7 @@ int Wait()
 		PutRecvLnBuff(b);
 
 		if (RegexActionType == REGEX_NONE) { // K\Ȃ̏ꍇ1oCg(wait command)
-			for (i = 9 ; i >= 0 ; i--) {
-				Str = PWaitStr[i];
-				if (Str!=NULL) {
-					if ((BYTE)Str[WaitCount[i]]==b) {
-						WaitCount[i]++;
-					}
-					else if (WaitCount[i]>0) {
-						for (j=WaitCount[i]-1; j>=0; j--) {
-							if ((BYTE)Str[j] == b) {
-								if (j== 0 || strncmp(Str, Str+(WaitCount[i]-j), j)==0) {
-									break;
-								}
-							}
-						}
-						if (j >= 0) {
-							WaitCount[i] = j+1;
-						}
-						else {
-							WaitCount[i] = 0;
-						}
-					}
-					if (WaitCount[i]==WaitStrLen[i]) {
-						Found = i+1;
-					}
-				}
-			}
+			Found = WaitMatch(&WaitState, b);
 		}
 	}
 
@@ -816,29 +1003,17 @@ BOOL WaitN()
 static int Wait4allOneBuffer(int index)
 {
 	BYTE b;
-	int i, Found;
-	PCHAR Str;
+	int Found;
 
+	if (WaitDirty) {
+		WaitBuild();
+	}
+
+	// obt@Ƃɏƍ̏Ԃ
 	Found = 0;
 	while ((Found==0) && read_macro_1byte(index, &b))
 	{
-		for (i = 9 ; i >= 0 ; i--) {
-			Str = PWaitStr[i];
-			if (Str!=NULL) {
-				if ((BYTE)Str[WaitCount[i]]==b) {
-					WaitCount[i]++;
-				}
-				else if (WaitCount[i]>0) {
-					WaitCount[i] = 0;
-					if ((BYTE)Str[0]==b) {
-						WaitCount[i] = 1;
-					}
-				}
-				if (WaitCount[i]==WaitStrLen[i]) {
-					Found = i+1;
-				}
-			}
-		}
+		Found = WaitMatch(&Wait4allState[index], b);
 	}
 
 //	if (Found>0) ClearWait();
@@ -966,6 +1141,16 @@ void SetXOption(int XOption)
 	DdeClientTransaction(Cmd,strlen(Cmd)+1,ConvH,0,CF_OEMTEXT,XTYP_EXECUTE,1000,NULL);
 }
 
+void SetSftpOption(int Resume)
+{
+	char Cmd[3];
+
+	Cmd[0] = CmdSetSftpOpt;
+	Cmd[1] = 0x30 + (Resume != 0);
+	Cmd[2] = 0;
+	DdeClientTransaction(Cmd,strlen(Cmd)+1,ConvH,0,CF_OEMTEXT,XTYP_EXECUTE,1000,NULL);
+}
+
 void SendSync()
 {
 	char Cmd[10];
@@ -61,6 +61,7 @@ void SetBinary(int BinFlag);
 void SetDebug(int DebugFlag);
 void SetLogOption(int *LogFlags);
 void SetXOption(int XOption);
+void SetSftpOption(int Resume);
 void SendSync();
 void SetSync(BOOL OnFlag);
 WORD SendCmnd(char OpId, int WaitFlag);
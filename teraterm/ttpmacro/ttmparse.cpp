@@ -37,6 +37,7 @@
 #define _CRTDBG_MAP_ALLOC
 #endif
 #include <stdlib.h>
+#include <stddef.h>
 #include <crtdbg.h>
 #include "ttmdlg.h"
 #include "ttmparse.h"
@@ -68,11 +69,23 @@ typedef struct {
 	WORD level;
 } TLab;
 
+// ϐ̒l
+//	Ă̂ strlen() ȂĂ悢
+//	QƃJEgĂāAϐԂ̑ł̓Rs[ɋL
+//	lύXƂ͏ɐVobt@̂ŁALɂ͉eȂ
+typedef struct {
+	int RefCount;
+	size_t Len;
+	char Str[1];
+} TStrBuf;
+
+#define STRBUF(s)	((TStrBuf *)((s) - offsetof(TStrBuf, Str)))
+
 typedef struct {
 	char *Name;
 	TVariableType Type;
 	union {
-		char *Str;
+		char *Str;		// TStrBuf.Str w
 		int Int;
 		TLab Lab;
 		TIntAry IntAry;
@@ -82,6 +95,60 @@ typedef struct {
 
 static Variable_t *Variables;
 static int VariableCount;
+static int VariableMax;		// Variables[] ̊mۍςݗvf
+
+// ϐ(x) Variables[] ̃CfbNXnbV\
+//	啶͋ʂȂ, -1=
+static int *VarHash;
+static int VarHashSize;		// 2ׂ̂
+
+// \̔茋ʂ̃LbV
+//	ʎqx̂ŁACheckReservedWord() 
+//	_stricmp() ̕т𖈉񂽂ǂȂ悤ɂ
+typedef struct {
+	char *Name;		// ʎq, NULL=
+	WORD WordId;	// 0=\ł͂Ȃ
+} TRsvCache;
+
+#define RSV_CACHE_SIZE 4096		// 2ׂ̂
+#define RSV_CACHE_MAX (RSV_CACHE_SIZE / 2)
+
+static TRsvCache *RsvCache;
+static int RsvCacheCount;
+
+static char *StrBufNew(const char *Str, size_t Len)
+{
+	TStrBuf *b = (TStrBuf *)malloc(offsetof(TStrBuf, Str) + Len + 1);
+	if (b == NULL) {
+		return NULL;
+	}
+	b->RefCount = 1;
+	b->Len = Len;
+	memcpy(b->Str, Str, Len);
+	b->Str[Len] = 0;
+	return b->Str;
+}
+
+static char *StrBufRetain(char *Str)
+{
+	if (Str != NULL) {
+		STRBUF(Str)->RefCount++;
+	}
+	return Str;
+}
+
+static void StrBufRelease(char *Str)
+{
+	TStrBuf *b;
+	if (Str == NULL) {
+		return;
+	}
+	b = STRBUF(Str);
+	b->RefCount--;
+	if (b->RefCount == 0) {
+		free(b);
+	}
+}
 
 // g[N̉͊JnʒuXVB
 static void UpdateLineParsePtr(void)
@@ -94,6 +161,9 @@ BOOL InitVar()
 {
 	Variables = NULL;
 	VariableCount = 0;
+	VariableMax = 0;
+	VarHash = NULL;
+	VarHashSize = 0;
 	return TRUE;
 }
 
@@ -104,14 +174,19 @@ void EndVar()
 		free(v->Name);
 		switch (v->Type) {
 		case TypeString:
-			free(v->Value.Str);
+			StrBufRelease(v->Value.Str);
 			break;
 		case TypeIntArray:
 			free(v->Value.IntAry.val);
 			break;
-		case TypeStrArray:
+		case TypeStrArray: {
+			int i;
+			for (i = 0; i < v->Value.StrAry.size; i++) {
+				StrBufRelease(v->Value.StrAry.val[i]);
+			}
 			free(v->Value.StrAry.val);
 			break;
+		}
 		default:
 			break;
 		}
@@ -119,6 +194,20 @@ void EndVar()
 	free(Variables);
 	Variables = NULL;
 	VariableCount = 0;
+	VariableMax = 0;
+	free(VarHash);
+	VarHash = NULL;
+	VarHashSize = 0;
+
+	if (RsvCache != NULL) {
+		int i;
+		for (i = 0; i < RSV_CACHE_SIZE; i++) {
+			free(RsvCache[i].Name);
+		}
+		free(RsvCache);
+		RsvCache = NULL;
+		RsvCacheCount = 0;
+	}
 }
 
 void DispErr(WORD Err)
@@ -173,7 +262,7 @@ void UnlockVar()
 {
 }
 
-BOOL CheckReservedWord(PCHAR Str, LPWORD WordId)
+static BOOL LookupReservedWord(PCHAR Str, LPWORD WordId)
 {
 	*WordId = 0;
 
@@ -379,6 +468,8 @@ BOOL CheckReservedWord(PCHAR Str, LPWORD WordId)
 		else if (_stricmp(Str,"setsync")==0) *WordId = RsvSetSync;
 		else if (_stricmp(Str,"settime")==0) *WordId = RsvSetTime;
 		else if (_stricmp(Str,"settitle")==0) *WordId = RsvSetTitle;
+		else if (_stricmp(Str,"sftprecv")==0) *WordId = RsvSftpRecv;
+		else if (_stricmp(Str,"sftpsend")==0) *WordId = RsvSftpSend;
 		else if (_stricmp(Str,"show")==0) *WordId = RsvShow;
 		else if (_stricmp(Str,"showtt")==0) *WordId = RsvShowTT;
 		else if (_stricmp(Str,"sprintf")==0) *WordId = RsvSprintf;  // add 'sprintf' (2007.5.1 yutaka)
@@ -446,6 +537,61 @@ BOOL CheckReservedWord(PCHAR Str, LPWORD WordId)
 	return (*WordId!=0);
 }
 
+/**
+ *	啶ʂȂnbVl (FNV-1a)
+ */
+static unsigned int HashNameI(const char *Name)
+{
+	unsigned int h = 2166136261U;
+	while (*Name != 0) {
+		h ^= (BYTE)tolower((BYTE)*Name);
+		h *= 16777619U;
+		Name++;
+	}
+	return h;
+}
+
+BOOL CheckReservedWord(PCHAR Str, LPWORD WordId)
+{
+	unsigned int i;
+	TRsvCache *c;
+	char *name;
+
+	if (RsvCache == NULL) {
+		RsvCache = (TRsvCache *)calloc(RSV_CACHE_SIZE, sizeof(TRsvCache));
+		if (RsvCache == NULL) {
+			return LookupReservedWord(Str, WordId);
+		}
+	}
+
+	i = HashNameI(Str) & (RSV_CACHE_SIZE - 1);
+	for (;;) {
+		c = &RsvCache[i];
+		if (c->Name == NULL) {
+			break;
+		}
+		if (_stricmp(c->Name, Str) == 0) {
+			*WordId = c->WordId;
+			return (*WordId!=0);
+		}
+		i = (i + 1) & (RSV_CACHE_SIZE - 1);
+	}
+
+	LookupReservedWord(Str, WordId);
+
+	// sɍ镶(execcmnd)̂ŁA萔ȏ͓o^Ȃ
+	if (RsvCacheCount < RSV_CACHE_MAX) {
+		name = _strdup(Str);
+		if (name != NULL) {
+			c->Name = name;
+			c->WordId = *WordId;
+			RsvCacheCount++;
+		}
+	}
+
+	return (*WordId!=0);
+}
+
 /* CRgĂ邩ǂ */
 int IsCommentClosed(void)
 {
@@ -849,15 +995,53 @@ BOOL GetNumber(int *Num)
 	return TRUE;
 }
 
-BOOL CheckVar(const char *Name, TVariableType *VarType, PVarId VarId)
+static void VarHashInsert(int index)
+{
+	unsigned int i = HashNameI(Variables[index].Name) & (VarHashSize - 1);
+	while (VarHash[i] != -1) {
+		i = (i + 1) & (VarHashSize - 1);
+	}
+	VarHash[i] = index;
+}
+
+/**
+ *	nbV\蒼
+ *	@param	size	nbV\̃TCY(2ׂ̂)
+ */
+static BOOL VarHashRebuild(int size)
 {
 	int i;
-	const Variable_t *v = Variables;
-	for (i = 0; i < VariableCount; v++,i++) {
-		if (_stricmp(v->Name, Name) == 0) {
-			*VarType = v->Type;
-			*VarId = (TVarId)i;
-			return TRUE;
+	if (size != VarHashSize) {
+		int *hash = (int *)malloc(sizeof(int) * size);
+		if (hash == NULL) {
+			return FALSE;
+		}
+		free(VarHash);
+		VarHash = hash;
+		VarHashSize = size;
+	}
+	for (i = 0; i < size; i++) {
+		VarHash[i] = -1;
+	}
+	for (i = 0; i < VariableCount; i++) {
+		VarHashInsert(i);
+	}
+	return TRUE;
+}
+
+BOOL CheckVar(const char *Name, TVariableType *VarType, PVarId VarId)
+{
+	if (VarHash != NULL) {
+		unsigned int i = HashNameI(Name) & (VarHashSize - 1);
+		int index;
+		while ((index = VarHash[i]) != -1) {
+			const Variable_t *v = &Variables[index];
+			if (_stricmp(v->Name, Name) == 0) {
+				*VarType = v->Type;
+				*VarId = (TVarId)index;
+				return TRUE;
+			}
+			i = (i + 1) & (VarHashSize - 1);
 		}
 	}
 	*VarType = TypUnknown;
@@ -867,22 +1051,41 @@ BOOL CheckVar(const char *Name, TVariableType *VarType, PVarId VarId)
 
 static Variable_t *NewVar(const char *name, TVariableType type)
 {
-	Variable_t *new_v = (Variable_t * )realloc(Variables, sizeof(Variable_t) * (VariableCount + 1));
-	if (new_v == NULL) {
-		// TODO Ȃ
+	if (VariableCount == VariableMax) {
+		// 1 realloc() ƕϐƂɒx̂Ŕ{XŊmۂ
+		int max = (VariableMax == 0) ? 64 : VariableMax * 2;
+		Variable_t *new_v = (Variable_t * )realloc(Variables, sizeof(Variable_t) * max);
+		if (new_v == NULL) {
+			// TODO Ȃ
+			return NULL;
+		};
+		Variables = new_v;
+		VariableMax = max;
+	}
+	if ((VariableCount + 1) * 2 > VarHashSize) {
+		// gp50%ȉɕۂ
+		if (! VarHashRebuild(VarHashSize == 0 ? 128 : VarHashSize * 2)) {
+			return NULL;
+		}
+	}
+	char *n = _strdup(name);
+	if (n == NULL) {
 		return NULL;
-	};
-	Variables = new_v;
+	}
 	Variable_t *v = &Variables[VariableCount];
-	VariableCount++;
-	v->Name = _strdup(name);
+	v->Name = n;
 	v->Type = type;
+	VarHashInsert(VariableCount);
+	VariableCount++;
 	return v;
 }
 
 BOOL NewIntVar(const char *Name, int InitVal)
 {
 	Variable_t *v = NewVar(Name, TypeInteger);
+	if (v == NULL) {
+		return FALSE;
+	}
 	v->Value.Int = InitVal;
 	return TRUE;
 }
@@ -890,13 +1093,19 @@ BOOL NewIntVar(const char *Name, int InitVal)
 BOOL NewStrVar(const char *Name, const char *InitVal)
 {
 	Variable_t *v = NewVar(Name, TypeString);
-	v->Value.Str = _strdup(InitVal);
+	if (v == NULL) {
+		return FALSE;
+	}
+	v->Value.Str = StrBufNew(InitVal, strlen(InitVal));
 	return TRUE;
 }
 
 int NewIntAryVar(const char *Name, int size)
 {
 	Variable_t *v = NewVar(Name, TypeIntArray);
+	if (v == NULL) {
+		return ErrFewMemory;
+	}
 	TIntAry *intAry = &v->Value.IntAry;
 	int *array = (int *)calloc(size, sizeof(int));
 	if (array == NULL) {
@@ -910,6 +1119,9 @@ int NewIntAryVar(const char *Name, int size)
 int NewStrAryVar(const char *Name, int size)
 {
 	Variable_t *v = NewVar(Name, TypeStrArray);
+	if (v == NULL) {
+		return ErrFewMemory;
+	}
 	TStrAry *strAry = &v->Value.StrAry;
 	char **array = (char **)calloc(size, sizeof(char *));
 	if (array == NULL) {
@@ -923,6 +1135,9 @@ int NewStrAryVar(const char *Name, int size)
 BOOL NewLabVar(const char *Name, BINT InitVal, WORD ILevel)
 {
 	Variable_t *v = NewVar(Name, TypeLabel);
+	if (v == NULL) {
+		return FALSE;
+	}
 	TLab *lab = &v->Value.Lab;
 	lab->val = InitVal;
 	lab->level = ILevel;
@@ -931,31 +1146,26 @@ BOOL NewLabVar(const char *Name, BINT InitVal, WORD ILevel)
 
 void DelLabVar(WORD ILevel)
 {
-	Variable_t *v = Variables;
-	for (;;) {
-		if (v == &Variables[VariableCount]) {
-			// Ō܂ŗ
-			break;
+	int i;
+	int count = 0;
+	for (i = 0; i < VariableCount; i++) {
+		Variable_t *v = &Variables[i];
+		if (v->Type == TypeLabel && v->Value.Lab.level >= ILevel) {
+			// 폜
+			free(v->Name);
+			continue;
 		}
-		if (v->Type == TypeLabel) {
-			if (v->Value.Lab.level >= ILevel) {
-				size_t left;
-				// 폜
-				free(v->Name);
-				// Oɂ߂
-				left = &Variables[VariableCount - 1] - v;
-				if (left > 0) {
-					memmove(v, v+1, sizeof(Variable_t) * left);
-				}
-				// 1
-				VariableCount--;
-
-				continue;
-			}
+		// Oɂ߂
+		if (count != i) {
+			Variables[count] = *v;
 		}
-		v++;
+		count++;
+	}
+	VariableCount = count;
+	// CfbNXς̂ō蒼
+	if (VarHash != NULL) {
+		VarHashRebuild(VarHashSize);
 	}
-	Variables = (Variable_t *)realloc(Variables, sizeof(Variable_t) * VariableCount);
 }
 
 void CopyLabel(WORD ILabel, BINT *Ptr, LPWORD Level)
@@ -1788,22 +1998,111 @@ void GetStrVar(PVarId VarId, LPWORD Err)
 		*Err = ErrSyntax;
 }
 
-void SetStrVal(TVarId VarId, const char *Str)
+/**
+ *	p[^擾
+ *	GetStrVal() ƈقȂAϐ̒l MaxStrLen Ő؂l߂Ȃ
+ *
+ *	@param[out]	Len		 (NULL̂Ƃ͕ԂȂ)
+ *	@return		, svɂȂ free() 
+ *				G[̂Ƃ NULL
+ */
+char *GetStrValAlloc(size_t *Len, LPWORD Err)
+{
+	TStrVal Str;
+	TVariableType VarType;
+	int VarId;
+	const char *src;
+	size_t len;
+	char *p;
+
+	if (*Err!=0) return NULL;
+
+	if (GetString(Str, Err)) {
+		if (*Err!=0) return NULL;
+		src = Str;
+		len = strlen(Str);
+	}
+	else if (GetExpression(&VarType, &VarId, Err)) {
+		if (*Err!=0) return NULL;
+		if (VarType!=TypString) {
+			*Err = ErrTypeMismatch;
+			return NULL;
+		}
+		src = StrVarPtr((TVarId)VarId);
+		len = StrVarLen((TVarId)VarId);
+	}
+	else {
+		*Err = ErrSyntax;
+		return NULL;
+	}
+
+	p = (char *)malloc(len + 1);
+	if (p == NULL) {
+		*Err = ErrFewMemory;
+		return NULL;
+	}
+	memcpy(p, src, len + 1);
+	if (Len != NULL) {
+		*Len = len;
+	}
+	return p;
+}
+
+static char **StrVarSlot(TVarId VarId)
 {
 	if (VarId >> 16) {
+		// zϐ
 		Variable_t *v = &Variables[(VarId>>16)-1];
-		char **str = &v->Value.StrAry.val[VarId & 0xffff];
-		free(*str);
-		*str = _strdup(Str);
+		return &v->Value.StrAry.val[VarId & 0xffff];
 	}
 	else {
+		// 
 		Variable_t *v = &Variables[VarId];
-		char **str = &v->Value.Str;
-		free(*str);
-		*str = _strdup(Str);
+		return &v->Value.Str;
 	}
 }
 
+void SetStrVal(TVarId VarId, const char *Str)
+{
+	SetStrValLen(VarId, Str, strlen(Str));
+}
+
+/**
+ *	w肵ĕϐɒlݒ肷
+ *	Str ͕ϐg̒lwĂĂ悢
+ */
+void SetStrValLen(TVarId VarId, const char *Str, size_t Len)
+{
+	char **str = StrVarSlot(VarId);
+	char *old = *str;
+	*str = StrBufNew(Str, Len);
+	StrBufRelease(old);
+}
+
+/**
+ *	ϐ̒lʂ̕ϐɑ
+ *	l̓Rs[ɋL
+ */
+void CopyStrVar(TVarId DestVarId, TVarId SrcVarId)
+{
+	char **dest = StrVarSlot(DestVarId);
+	char *old = *dest;
+	*dest = StrBufRetain(*StrVarSlot(SrcVarId));
+	StrBufRelease(old);
+}
+
+/**
+ *	ϐ̕񒷂Ԃ
+ */
+size_t StrVarLen(TVarId VarId)
+{
+	char *str = *StrVarSlot(VarId);
+	if (str == NULL) {
+		return 0;
+	}
+	return STRBUF(str)->Len;
+}
+
 /**
  *	ϐ̓eԂ
  */
@@ -1824,6 +2123,10 @@ const char *StrVarPtr(TVarId VarId)
 	else {
 		// 
 		v = &Variables[VarId];
+		if (v->Value.Str == NULL) {
+			// mۂłȂꍇ
+			return "";
+		}
 		return v->Value.Str;
 	}
 }
@@ -296,6 +296,8 @@ typedef enum {
 #define RsvDelPassword2 221
 #define RsvIsPassword2  222
 #define RsvGetTTPos     223
+#define RsvSftpRecv     224
+#define RsvSftpSend     225
 
 #define RsvOperator     1000
 #define RsvBNot         1001
@@ -371,8 +373,12 @@ void GetIntVar(PVarId VarId, LPWORD Err);
 void GetStrVal(PCHAR Str, LPWORD Err);
 void GetStrVal2(PCHAR Str, LPWORD Err, BOOL AutoConversion);
 void GetStrVar(PVarId VarId, LPWORD Err);
+char *GetStrValAlloc(size_t *Len, LPWORD Err);
 void SetStrVal(TVarId VarId, const char *Str);
+void SetStrValLen(TVarId VarId, const char *Str, size_t Len);
+void CopyStrVar(TVarId DestVarId, TVarId SrcVarId);
 const char *StrVarPtr(TVarId VarId);
+size_t StrVarLen(TVarId VarId);
 void GetVarType(TVariableType *ValType, int *Val, LPWORD Err);
 TVarId GetIntVarFromArray(TVarId VarId, int Index, LPWORD Err);
 TVarId GetStrVarFromArray(TVarId VarId, int Index, LPWORD Err);
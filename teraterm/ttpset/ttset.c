@@ -1810,6 +1810,14 @@ void PASCAL _ReadIniFile(const wchar_t *FName, PTTSet ts)
 	ts->MaxOSCBufferSize =
 		GetPrivateProfileInt(Section, "MaxOSCBufferSize", 4096, FName);
 
+	// Receive buffer size
+	ts->RecvBufferSize =
+		GetPrivateProfileInt(Section, "RecvBufferSize", InBuffSizeDefault, FName);
+	if (ts->RecvBufferSize < InBuffSize)
+		ts->RecvBufferSize = InBuffSize;
+	else if (ts->RecvBufferSize > InBuffSizeMax)
+		ts->RecvBufferSize = InBuffSizeMax;
+
 	ts->JoinSplitURL = GetOnOff(Section, "JoinSplitURL", FName, FALSE);
 
 	GetPrivateProfileString(Section, "JoinSplitURLIgnoreEOLChar", "\\", Temp, sizeof(Temp), FName);
@@ -3120,6 +3128,9 @@ void PASCAL _WriteIniFile(const wchar_t *FName, PTTSet ts)
 	// Max OSC string buffer size
 	WriteInt(Section, "MaxOSCBufferSize", FName, ts->MaxOSCBufferSize);
 
+	// Receive buffer size
+	WriteInt(Section, "RecvBufferSize", FName, ts->RecvBufferSize);
+
 	WriteOnOff(Section, "JoinSplitURL", FName, ts->JoinSplitURL);
 
 	_snprintf_s(Temp, sizeof(Temp), _TRUNCATE, "%c", ts->JoinSplitURLIgnoreEOLChar);
@@ -47,8 +47,8 @@
 /* buffer_t.buf ̊g̏l (16MB) */
 #define BUFFER_SIZE_MAX 0x1000000
 
-/* buffer_t.buf ̊gɒǉŊmۂ (32KB) */
-#define BUFFER_INCREASE_MARGIN (32*1024)
+/* buffer_t.buf ̏TCY (4KB) */
+#define BUFFER_INITIAL_SIZE 4096
 
 #if 0
 typedef struct buffer {
@@ -56,9 +56,158 @@ typedef struct buffer {
 	size_t offset;     /* ݂̓ǂݏoʒu */
 	size_t maxlen;     /* obt@̍őTCY */
 	size_t len;        /* obt@Ɋ܂܂Lȃf[^TCY */
+	int secret;        /* 閧܂ނ */
 } buffer_t;
 #endif
 
+/*
+ * ꂽobt@̃v[
+ *
+ * buffer_free() ꂽobt@́A傫(BUFFER_POOL_CLASSES iK)
+ * ĂA buffer_init() Ŏg񂷁B
+ * pPbgƂɊmہEJԂbZ[Wobt@ malloc()/free() 炷B
+ * 閧܂ރobt@(buffer_init_secret())̓v[ɖ߂AĉB
+ */
+#define BUFFER_POOL_CLASSES 3
+#define BUFFER_POOL_DEPTH 8
+#define BUFFER_POOL_MAXLEN (256*1024)  /* 傫obt@̓v[ɖ߂Ȃ */
+static const size_t buffer_pool_class_size[BUFFER_POOL_CLASSES] = {
+	BUFFER_INITIAL_SIZE, 16*1024, 64*1024,
+};
+static buffer_t *buffer_pool[BUFFER_POOL_CLASSES][BUFFER_POOL_DEPTH];
+static int buffer_pool_count[BUFFER_POOL_CLASSES];
+static CRITICAL_SECTION buffer_pool_cs;  /* buffer_pool_init() ŏ */
+static buffer_stat_t buffer_stat;  /* SCP ̃XbhXV̂ buffer_pool_lock() ɐG */
+
+static void buffer_pool_lock(void)
+{
+	EnterCriticalSection(&buffer_pool_cs);
+}
+
+static void buffer_pool_unlock(void)
+{
+	LeaveCriticalSection(&buffer_pool_cs);
+}
+
+// v[̃bNBDLL ̃[h1񂾂ĂԁB
+void buffer_pool_init(void)
+{
+	InitializeCriticalSection(&buffer_pool_cs);
+}
+
+// v[ɎcĂobt@AbN폜BDLL ̃A[hɌĂԁB
+void buffer_pool_end(void)
+{
+	buffer_pool_clear();
+	DeleteCriticalSection(&buffer_pool_cs);
+}
+
+static buffer_t *buffer_pool_get(void)
+{
+	buffer_t *buf = NULL;
+	int i;
+
+	buffer_pool_lock();
+	for (i = 0; i < BUFFER_POOL_CLASSES; i++) {
+		if (buffer_pool_count[i] > 0) {
+			buf = buffer_pool[i][--buffer_pool_count[i]];
+			buffer_stat.reuses++;
+			break;
+		}
+	}
+	buffer_pool_unlock();
+
+	return buf;
+}
+
+static BOOL buffer_pool_put(buffer_t *buf)
+{
+	BOOL ret = FALSE;
+	int i;
+
+	if (buf->secret || buf->maxlen > BUFFER_POOL_MAXLEN) {
+		return FALSE;
+	}
+
+	buffer_pool_lock();
+	for (i = BUFFER_POOL_CLASSES - 1; i >= 0; i--) {
+		if (buf->maxlen >= buffer_pool_class_size[i]) {
+			if (buffer_pool_count[i] < BUFFER_POOL_DEPTH) {
+				buffer_pool[i][buffer_pool_count[i]++] = buf;
+				ret = TRUE;
+			}
+			break;
+		}
+	}
+	buffer_pool_unlock();
+
+	return ret;
+}
+
+// v[ɎcĂobt@ׂĉB
+void buffer_pool_clear(void)
+{
+	int i;
+
+	buffer_pool_lock();
+	for (i = 0; i < BUFFER_POOL_CLASSES; i++) {
+		while (buffer_pool_count[i] > 0) {
+			buffer_t *buf = buffer_pool[i][--buffer_pool_count[i]];
+			free(buf->buf);
+			free(buf);
+			buffer_stat.frees++;
+		}
+	}
+	buffer_pool_unlock();
+}
+
+// obt@̊mہẺ񐔂擾B
+void buffer_get_stat(buffer_stat_t *stat)
+{
+	buffer_pool_lock();
+	*stat = buffer_stat;
+	buffer_pool_unlock();
+}
+
+// obt@ n oCg傫Ȃ܂Ŕ{XŊgB
+static void buffer_grow(buffer_t *buf, size_t n)
+{
+	size_t newlen = buf->maxlen;
+	char *p;
+
+	while (newlen <= n) {
+		newlen *= 2;
+	}
+	if (newlen > BUFFER_SIZE_MAX) {
+		if (n >= BUFFER_SIZE_MAX) {
+			abort();
+		}
+		newlen = BUFFER_SIZE_MAX;
+	}
+
+	if (buf->secret) {
+		// 閧񂪌Â̈ɎcȂ悤ARs[Ă
+		p = malloc(newlen);
+		if (p == NULL) {
+			abort();
+		}
+		memcpy(p, buf->buf, buf->maxlen);
+		SecureZeroMemory(buf->buf, buf->maxlen);
+		free(buf->buf);
+	} else {
+		p = realloc(buf->buf, newlen);
+		if (p == NULL) {
+			abort();
+		}
+	}
+	buf->buf = p;
+	buf->maxlen = newlen;
+
+	buffer_pool_lock();
+	buffer_stat.grows++;
+	buffer_pool_unlock();
+}
+
 // obt@̃ItZbgA܂ǂłȂԂɂB
 // Tera Term(TTSSH)IWi֐B
 void buffer_rewind(buffer_t *buf)
@@ -72,11 +221,11 @@ void buffer_clear(buffer_t *buf)
 	buf->len = 0;
 }
 
-buffer_t *buffer_init(void)
+static buffer_t *buffer_new(void)
 {
 	void *ptr;
 	buffer_t *buf;
-	size_t size = 4096;
+	size_t size = BUFFER_INITIAL_SIZE;
 
 	buf = malloc(sizeof(buffer_t));
 	ptr = malloc(size);
@@ -87,22 +236,59 @@ buffer_t *buffer_init(void)
 		buf->maxlen = size;
 		buf->len = 0;
 		buf->offset = 0;
+		buf->secret = 0;
 
 	} else {
 		ptr = NULL; *(char *)ptr = 0;
 	}
 
+	buffer_pool_lock();
+	buffer_stat.mallocs++;
+	buffer_pool_unlock();
+
+	return (buf);
+}
+
+buffer_t *buffer_init(void)
+{
+	buffer_t *buf;
+
+	buf = buffer_pool_get();
+	if (buf != NULL) {
+		buffer_clear(buf);
+		return (buf);
+	}
+
+	return buffer_new();
+}
+
+// pX[hȂǂ̔閧obt@mۂB
+// v[͎炸Aɂ͓eB
+buffer_t *buffer_init_secret(void)
+{
+	buffer_t *buf = buffer_new();
+
+	buf->secret = 1;
+
 	return (buf);
 }
 
 void buffer_free(buffer_t * buf)
 {
 	if (buf != NULL) {
+		if (buffer_pool_put(buf)) {
+			return;
+		}
 		// ZLeB΍ (2006.8.3 yutaka)
-		int len =  buffer_len(buf);
-		SecureZeroMemory(buf->buf, len);
+		if (buf->secret) {
+			SecureZeroMemory(buf->buf, buf->maxlen);
+		}
 		free(buf->buf);
 		free(buf);
+
+		buffer_pool_lock();
+		buffer_stat.frees++;
+		buffer_pool_unlock();
 	}
 }
 
@@ -111,7 +297,6 @@ void buffer_free(buffer_t * buf)
 void *buffer_append_space(buffer_t * buf, size_t size)
 {
 	size_t n;
-	size_t newlen;
 	void *p;
 
 	n = buf->offset + size;
@@ -119,14 +304,7 @@ void *buffer_append_space(buffer_t * buf, size_t size)
 		//
 	} else {
 		// obt@Ȃ̂ŕ[B(2005.7.2 yutaka)
-		newlen = buf->maxlen + size + BUFFER_INCREASE_MARGIN;
-		if (newlen > BUFFER_SIZE_MAX) {
-			goto panic;
-		}
-		buf->buf = realloc(buf->buf, newlen);
-		if (buf->buf == NULL)
-			goto panic;
-		buf->maxlen = newlen;
+		buffer_grow(buf, n);
 	}
 
 	p = buf->buf + buf->offset;
@@ -134,45 +312,24 @@ void *buffer_append_space(buffer_t * buf, size_t size)
 	buf->len = buf->offset + size;
 
 	return (p);
-
-panic:
-	abort();
-	return (NULL);
 }
 
 int buffer_append(buffer_t * buf, const void *ptr, size_t size)
 {
 	size_t n;
 	int ret = -1;
-	size_t newlen;
-
-	for (;;) {
-		n = buf->offset + size;
-		if (n < buf->maxlen) {
-			memcpy(buf->buf + buf->offset, ptr, size);
-			buf->offset += size;
-			buf->len = buf->offset;
-			ret = 0;
-			break;
 
-		} else {
-			// obt@Ȃ̂ŕ[B(2005.7.2 yutaka)
-			newlen = buf->maxlen + size + BUFFER_INCREASE_MARGIN;
-			if (newlen > BUFFER_SIZE_MAX) {
-				goto panic;
-			}
-			buf->buf = realloc(buf->buf, newlen);
-			if (buf->buf == NULL)
-				goto panic;
-			buf->maxlen = newlen;
-		}
+	n = buf->offset + size;
+	if (n >= buf->maxlen) {
+		// obt@Ȃ̂ŕ[B(2005.7.2 yutaka)
+		buffer_grow(buf, n);
 	}
+	memcpy(buf->buf + buf->offset, ptr, size);
+	buf->offset += size;
+	buf->len = buf->offset;
+	ret = 0;
 
 	return (ret);
-
-panic:
-	abort();
-	return (ret);
 }
 
 int buffer_append_length(buffer_t * msg, const void *ptr, size_t size)
@@ -234,6 +391,15 @@ unsigned int buffer_get_int(buffer_t *msg)
 	return (ret);
 }
 
+unsigned long long buffer_get_int64(buffer_t *msg)
+{
+	unsigned long long ret;
+
+	ret = (unsigned long long)buffer_get_int(msg) << 32;
+	ret |= buffer_get_int(msg);
+	return (ret);
+}
+
 int buffer_get_char_ret(char *ret, buffer_t *msg)
 {
 	if (buffer_get_ret(msg, ret, 1) == -1)
@@ -358,6 +524,12 @@ void buffer_put_int(buffer_t *msg, int value)
 	buffer_append(msg, buf, sizeof(buf));
 }
 
+void buffer_put_int64(buffer_t *msg, unsigned long long value)
+{
+	buffer_put_int(msg, (int)(value >> 32));
+	buffer_put_int(msg, (int)(value & 0xffffffff));
+}
+
 int buffer_len(buffer_t *msg)
 {
 	return (int)(msg->len);
@@ -596,10 +768,38 @@ void buffer_consume_end(buffer_t *buf, size_t shift_byte)
 }
 
 
+// kEWJ̏o͐ƂāAbuf ݈̏ʒu(offset)ȍ~ hint oCgȏ
+// 󂫂pӂAzstream ̏o͐ɐݒ肷B
+static int buffer_reserve_zstream(buffer_t *buf, z_stream *zstream, size_t hint)
+{
+	size_t need = buf->offset + hint;
+
+	if (need > buf->maxlen) {
+		if (need >= BUFFER_SIZE_MAX) {
+			return -1;
+		}
+		buffer_grow(buf, need);
+	}
+
+	zstream->next_out = (Bytef *)(buf->buf + buf->offset);
+	zstream->avail_out = (uInt)(buf->maxlen - buf->offset);
+	assert(buf->maxlen - buf->offset == (size_t)(uInt)(buf->maxlen - buf->offset));
+
+	return 0;
+}
+
+// zstream 񂾂Ƃ܂ buf ݈̏ʒui߂B
+static void buffer_commit_zstream(buffer_t *buf, z_stream *zstream)
+{
+	buf->offset = (char *)zstream->next_out - buf->buf;
+	buf->len = buf->offset;
+}
+
 // pPbg̈k
+// kf[^ compbuf ɒڏށB
 int buffer_compress(z_stream *zstream, char *payload, size_t len, buffer_t *compbuf)
 {
-	unsigned char buf[4096];
+	size_t hint;
 	int status;
 
 	// input buffer
@@ -607,27 +807,34 @@ int buffer_compress(z_stream *zstream, char *payload, size_t len, buffer_t *comp
 	zstream->avail_in = (uInt)len;
 	assert(len == (size_t)(uInt)len);
 
+	// kƁAtɃTCY傫Ȃ邱Ƃl邱ƁB
+	hint = len + (len >> 6) + 64;
+
 	do {
 		// output buffer
-		zstream->next_out = buf;
-		zstream->avail_out = sizeof(buf);
+		if (buffer_reserve_zstream(compbuf, zstream, hint) == -1) {
+			return -1; // error
+		}
 
-		// obt@kBkƁAtɃTCY傫Ȃ邱Ƃl邱ƁB
 		status = deflate(zstream, Z_PARTIAL_FLUSH);
-		if (status == Z_OK) {
-			buffer_append(compbuf, buf, sizeof(buf) - zstream->avail_out);
-		} else {
+		buffer_commit_zstream(compbuf, zstream);
+		if (status == Z_BUF_ERROR && zstream->avail_in == 0) {
+			// o͂󂫂ɂ傤ǎ܂Ă
+			break;
+		} else if (status != Z_OK) {
 			return -1; // error
 		}
+		hint = compbuf->maxlen;
 	} while (zstream->avail_out == 0);
 
 	return 0; // success
 }
 
 // pPbg̓WJ
+// WJf[^ compbuf ɒڏށB
 int buffer_decompress(z_stream *zstream, char *payload, size_t len, buffer_t *compbuf)
 {
-	unsigned char buf[4096];
+	size_t hint;
 	int status;
 
 	// input buffer
@@ -635,22 +842,25 @@ int buffer_decompress(z_stream *zstream, char *payload, size_t len, buffer_t *co
 	zstream->avail_in = (uInt)len;
 	assert(len == (size_t)(uInt)len);
 
+	// WJ̃TCY͕Ȃ̂ŁA܂͈kf[^4{pӂĂB
+	hint = len * 4 + 64;
+
 	do {
 		// output buffer
-		zstream->next_out = buf;
-		zstream->avail_out = sizeof(buf);
+		if (buffer_reserve_zstream(compbuf, zstream, hint) == -1) {
+			return -1; // error
+		}
 
 		// obt@WJB
 		status = inflate(zstream, Z_PARTIAL_FLUSH);
-		if (status == Z_OK) {
-			buffer_append(compbuf, buf, sizeof(buf) - zstream->avail_out);
-
-		} else if (status == Z_OK) {
+		buffer_commit_zstream(compbuf, zstream);
+		if (status == Z_BUF_ERROR && zstream->avail_in == 0) {
+			// o͂󂫂ɂ傤ǎ܂Ă
 			break;
-
-		} else {
+		} else if (status != Z_OK) {
 			return -1; // error
 		}
+		hint = compbuf->maxlen;
 	} while (zstream->avail_out == 0);
 
 	return 0; // success
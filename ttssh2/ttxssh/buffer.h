@@ -38,14 +38,28 @@ typedef struct buffer {
 	size_t offset; /* ݂̓ǂݏoʒu */
 	size_t maxlen; /* obt@̍őTCY */
 	size_t len;	   /* obt@Ɋ܂܂Lȃf[^TCY */
+	int secret;	   /* 閧܂ނBɏB */
 } buffer_t;
 #else
 typedef struct buffer buffer_t;
 #endif
 
+/* obt@̊mہẺ */
+typedef struct buffer_stat {
+	unsigned long mallocs;  /* VɊmۂ */
+	unsigned long frees;    /*  */
+	unsigned long reuses;   /* v[ėp */
+	unsigned long grows;    /* g */
+} buffer_stat_t;
+
 void buffer_clear(buffer_t *buf);
 buffer_t *buffer_init(void);
+buffer_t *buffer_init_secret(void);
 void buffer_free(buffer_t *buf);
+void buffer_pool_init(void);
+void buffer_pool_end(void);
+void buffer_pool_clear(void);
+void buffer_get_stat(buffer_stat_t *stat);
 void *buffer_append_space(buffer_t * buf, size_t size);
 int buffer_append(buffer_t *buf, const void *ptr, size_t size);
 int buffer_append_length(buffer_t *msg, const void *ptr, size_t size);
@@ -56,6 +70,7 @@ void buffer_put_cstring(buffer_t *msg, const char *ptr);
 void buffer_put_char(buffer_t *msg, int value);
 void buffer_put_padding(buffer_t *msg, size_t size);
 void buffer_put_int(buffer_t *msg, int value);
+void buffer_put_int64(buffer_t *msg, unsigned long long value);
 int buffer_len(buffer_t *msg);
 char *buffer_ptr(buffer_t *msg);
 void buffer_put_bignum(buffer_t *buffer, const BIGNUM *value);
@@ -75,6 +90,7 @@ int buffer_decompress(z_stream *zstream, char *payload, size_t len, buffer_t *co
 int buffer_get_ret(buffer_t *msg, void *buf, size_t len);
 int buffer_get_int_ret(unsigned int *ret, buffer_t *msg);
 unsigned int buffer_get_int(buffer_t *msg);
+unsigned long long buffer_get_int64(buffer_t *msg);
 int buffer_get_char_ret(char *ret, buffer_t *msg);
 int buffer_get_char(buffer_t *msg);
 void buffer_rewind(buffer_t *buf);
@@ -72,9 +72,6 @@
 
 #define CMP(a,b) memcmp(a, b, SSH_BLOCKSIZE)
 
-static unsigned char *encbuff = NULL;
-static unsigned int encbufflen = 0;
-
 static void crc_update(uint32 *a, uint32 b)
 {
 	b ^= *a;
@@ -200,12 +197,10 @@ BOOL CRYPT_detect_attack(PTInstVar pvar, unsigned char *buf, int bytes)
 
 BOOL CRYPT_encrypt_aead(PTInstVar pvar, unsigned char *data, unsigned int bytes, unsigned int aadlen, unsigned int authlen)
 {
-	unsigned char *newbuff = NULL;
 	unsigned int block_size = pvar->ssh2_keys[MODE_OUT].enc.block_size;
 	unsigned char lastiv[1];
 	char tmp[80];
 	struct sshcipher_ctx *cc = pvar->cc[MODE_OUT];
-	unsigned int newbuff_len = bytes;
 
 	if (bytes == 0)
 		return TRUE;
@@ -219,25 +214,16 @@ BOOL CRYPT_encrypt_aead(PTInstVar pvar, unsigned char *data, unsigned int bytes,
 		return FALSE;
 	}
 
+	// Íׂ͂ăobt@ł̂܂(in-place)sB
+	// Ɨpobt@֏o͂Ă珑߂Rs[svɂȂB
 	if (cc->cipher->id == SSH2_CIPHER_CHACHAPOLY) {
 		// chacha20-poly1305 ł aadlen Í̑Ώ
 		//   aadlen  bytes ͕ʁXɈÍ
 		// chachapoly_crypt ̒ŔF؃f[^(AEAD tag)
-		newbuff_len += aadlen + authlen;
-	}
-	if (newbuff_len > encbufflen) {
-		if ((newbuff = realloc(encbuff, newbuff_len)) == NULL)
-			goto err;
-		encbuff = newbuff;
-		encbufflen = newbuff_len;
-	}
-
-	if (cc->cipher->id == SSH2_CIPHER_CHACHAPOLY) {
 		if (chachapoly_crypt(cc->cp_ctx, pvar->ssh_state.sender_sequence_number,
-		                     encbuff, data, bytes, aadlen, authlen, 1) != 0) {
+		                     data, data, bytes, aadlen, authlen, 1) != 0) {
 			goto err;
 		}
-		memcpy(data, encbuff, aadlen + bytes + authlen);
 		return TRUE;
 	}
 
@@ -248,11 +234,9 @@ BOOL CRYPT_encrypt_aead(PTInstVar pvar, unsigned char *data, unsigned int bytes,
 		goto err;
 
 	// AES-GCM ł aadlen ÍȂ̂ŁA̐悾Í
-	if (EVP_Cipher(cc->evp, encbuff, data+aadlen, bytes) < 0)
+	if (EVP_Cipher(cc->evp, data+aadlen, data+aadlen, bytes) < 0)
 		goto err;
 
-	memcpy(data+aadlen, encbuff, bytes);
-
 	if (EVP_Cipher(cc->evp, NULL, NULL, 0) < 0)
 		goto err;
 
@@ -271,12 +255,10 @@ err:
 
 BOOL CRYPT_decrypt_aead(PTInstVar pvar, unsigned char *data, unsigned int bytes, unsigned int aadlen, unsigned int authlen)
 {
-	unsigned char *newbuff = NULL;
 	unsigned int block_size = pvar->ssh2_keys[MODE_IN].enc.block_size;
 	unsigned char lastiv[1];
 	char tmp[80];
 	struct sshcipher_ctx *cc = pvar->cc[MODE_IN];
-	unsigned int newbuff_len = bytes;
 
 	if (bytes == 0)
 		return TRUE;
@@ -290,23 +272,14 @@ BOOL CRYPT_decrypt_aead(PTInstVar pvar, unsigned char *data, unsigned int bytes,
 		return FALSE;
 	}
 
+	// ͎Mobt@ł̂܂(in-place)sB
 	if (cc->cipher->id == SSH2_CIPHER_CHACHAPOLY) {
 		// chacha20-poly1305 ł aadlen ÍĂ
-		newbuff_len += aadlen;
-	}
-	if (newbuff_len > encbufflen) {
-		if ((newbuff = realloc(encbuff, newbuff_len)) == NULL)
-			goto err;
-		encbuff = newbuff;
-		encbufflen = newbuff_len;
-	}
-
-	if (cc->cipher->id == SSH2_CIPHER_CHACHAPOLY) {
+		// F؃f[^(AEAD tag)̌؂͕Oɍs
 		if (chachapoly_crypt(cc->cp_ctx, pvar->ssh_state.receiver_sequence_number,
-		                     encbuff, data, bytes, aadlen, authlen, 0) != 0) {
+		                     data, data, bytes, aadlen, authlen, 0) != 0) {
 			goto err;
 		}
-		memcpy(data, encbuff, aadlen + bytes);
 		return TRUE;
 	}
 
@@ -320,11 +293,9 @@ BOOL CRYPT_decrypt_aead(PTInstVar pvar, unsigned char *data, unsigned int bytes,
 		goto err;
 
 	// AES-GCM ł aadlen ÍȂ̂ŁA̐悾
-	if (EVP_Cipher(cc->evp, encbuff, data+aadlen, bytes) < 0)
+	if (EVP_Cipher(cc->evp, data+aadlen, data+aadlen, bytes) < 0)
 		goto err;
 
-	memcpy(data+aadlen, encbuff, bytes);
-
 	if (EVP_Cipher(cc->evp, NULL, NULL, 0) < 0)
 		goto err;
 
@@ -344,7 +315,6 @@ static void no_encrypt(PTInstVar pvar, unsigned char *buf, unsigned int bytes)
 
 static void crypt_SSH2_encrypt(PTInstVar pvar, unsigned char *buf, unsigned int bytes)
 {
-	unsigned char *newbuff;
 	int block_size = pvar->ssh2_keys[MODE_OUT].enc.block_size;
 	char tmp[80];
 
@@ -361,26 +331,16 @@ static void crypt_SSH2_encrypt(PTInstVar pvar, unsigned char *buf, unsigned int
 		return;
 	}
 
-	if (bytes > encbufflen) {
-		if ((newbuff = realloc(encbuff, bytes)) == NULL)
-			return;
-		encbuff = newbuff;
-		encbufflen = bytes;
-	}
-
-	if (EVP_Cipher(pvar->cc[MODE_OUT]->evp, encbuff, buf, bytes) == 0) {
+	if (EVP_Cipher(pvar->cc[MODE_OUT]->evp, buf, buf, bytes) == 0) {
 		UTIL_get_lang_msg("MSG_ENCRYPT_ERROR2", pvar, "%s encrypt error(2)");
 		_snprintf_s(tmp, sizeof(tmp), _TRUNCATE, pvar->UIMsg,
 		            get_cipher_name(pvar->crypt_state.sender_cipher));
 		notify_fatal_error(pvar, tmp, TRUE);
-	} else {
-		memcpy(buf, encbuff, bytes);
 	}
 }
 
 static void crypt_SSH2_decrypt(PTInstVar pvar, unsigned char *buf, unsigned int bytes)
 {
-	unsigned char *newbuff;
 	int block_size = pvar->ssh2_keys[MODE_IN].enc.block_size;
 	char tmp[80];
 
@@ -397,20 +357,13 @@ static void crypt_SSH2_decrypt(PTInstVar pvar, unsigned char *buf, unsigned int
 		return;
 	}
 
-	if (bytes > encbufflen) {
-		if ((newbuff = malloc(bytes)) == NULL)
-			return;
-		encbuff = newbuff;
-		encbufflen = bytes;
-	}
-
-	if (EVP_Cipher(pvar->cc[MODE_IN]->evp, encbuff, buf, bytes) == 0) {
+	// Mobt@ł̂܂ܕB
+	// OpenSSL  EVP Í cipher-ctr.c  CTR ͓o͂̈ł悢B
+	if (EVP_Cipher(pvar->cc[MODE_IN]->evp, buf, buf, bytes) == 0) {
 		UTIL_get_lang_msg("MSG_DECRYPT_ERROR2", pvar, "%s decrypt error(2)");
 		_snprintf_s(tmp, sizeof(tmp), _TRUNCATE, pvar->UIMsg,
 		            get_cipher_name(pvar->crypt_state.receiver_cipher));
 		notify_fatal_error(pvar, tmp, TRUE);
-	} else {
-		memcpy(buf, encbuff, bytes);
 	}
 }
 
@@ -666,6 +619,38 @@ unsigned int CRYPT_get_receiver_MAC_size(PTInstVar pvar)
 
 }
 
+// ݒς݂ HMAC ReLXgԂB
+// ȑO̓pPbgƂ HMAC_CTX_new() ƌ̐ݒĂA
+// ς(NEWKEYS)܂œReLXgg񂵁AԂɖ߂ɂB
+static HMAC_CTX *get_MAC_ctx(struct Mac *mac)
+{
+	if (mac->ctx == NULL) {
+		mac->ctx = HMAC_CTX_new();
+		if (mac->ctx == NULL) {
+			return NULL;
+		}
+		if (!HMAC_Init_ex(mac->ctx, mac->key, mac->key_len, mac->md, NULL)) {
+			CRYPT_free_MAC_ctx(mac);
+			return NULL;
+		}
+	}
+	else {
+		// key  md  NULL nƁAǑ̂܂܏Ԃɖ߂
+		if (!HMAC_Init_ex(mac->ctx, NULL, 0, NULL, NULL)) {
+			return NULL;
+		}
+	}
+	return mac->ctx;
+}
+
+void CRYPT_free_MAC_ctx(struct Mac *mac)
+{
+	if (mac->ctx != NULL) {
+		HMAC_CTX_free(mac->ctx);
+		mac->ctx = NULL;
+	}
+}
+
 // HMAČ
 // {֐ SSH2 ł̂ݎgpB
 // (2004.12.17 yutaka)
@@ -694,16 +679,14 @@ BOOL CRYPT_verify_receiver_MAC(PTInstVar pvar, uint32 sequence_number,
 		goto error;
 	}
 
-	c = HMAC_CTX_new();
+	c = get_MAC_ctx(mac);
 	if (c == NULL)
 		goto error;
 
-	HMAC_Init_ex(c, mac->key, mac->key_len, mac->md, NULL);
 	set_uint32_MSBfirst(b, sequence_number);
 	HMAC_Update(c, b, sizeof(b));
 	HMAC_Update(c, data, len);
 	HMAC_Final(c, m, NULL);
-	// HMAC_cleanup()OpenSSL 1.1.0ō폜AHMAC_CTX_free()ɏW񂳂ꂽB
 
 	if (memcmp(m, MAC, mac->mac_len)) {
 		logprintf(LOG_LEVEL_VERBOSE, "HMAC key is not matched(seq %lu len %d)", sequence_number, len);
@@ -712,14 +695,9 @@ BOOL CRYPT_verify_receiver_MAC(PTInstVar pvar, uint32 sequence_number,
 		goto error;
 	}
 
-	HMAC_CTX_free(c);
-
 	return TRUE;
 
 error:
-	if (c)
-		HMAC_CTX_free(c);
-
 	return FALSE;
 }
 
@@ -752,23 +730,19 @@ BOOL CRYPT_build_sender_MAC(PTInstVar pvar, uint32 sequence_number,
 		if (mac == NULL || mac->enabled == 0)
 			return FALSE;
 
-		c = HMAC_CTX_new();
+		c = get_MAC_ctx(mac);
 		if (c == NULL)
 			return FALSE;
 
-		HMAC_Init_ex(c, mac->key, mac->key_len, mac->md, NULL);
 		set_uint32_MSBfirst(b, sequence_number);
 		HMAC_Update(c, b, sizeof(b));
 		HMAC_Update(c, data, len);
 		HMAC_Final(c, m, NULL);
-		// HMAC_cleanup()OpenSSL 1.1.0ō폜AHMAC_CTX_free()ɏW񂳂ꂽB
 
 		// 20oCgRs[
 		memcpy(MAC, m, pvar->ssh2_keys[MODE_OUT].mac.mac_len);
 	//	memcpy(MAC, m, sizeof(m));
 
-		HMAC_CTX_free(c);
-
 		return TRUE;
 	}
 
@@ -1216,10 +1190,6 @@ void CRYPT_free_public_key(CRYPTPublicKey * key)
 
 void CRYPT_end(PTInstVar pvar)
 {
-	free(encbuff);
-	encbuff = NULL;
-	encbufflen = 0;
-
 	destroy_public_key(&pvar->crypt_state.host_key);
 	destroy_public_key(&pvar->crypt_state.server_key);
 
@@ -136,6 +136,7 @@ BOOL CRYPT_verify_receiver_MAC(PTInstVar pvar, uint32 sequence_number,
   char *data, int len, char *MAC);
 unsigned int CRYPT_get_sender_MAC_size(PTInstVar pvar);
 
+void CRYPT_free_MAC_ctx(struct Mac *mac);
 BOOL CRYPT_build_sender_MAC(PTInstVar pvar, uint32 sequence_number,
   char *data, int len, char *MAC);
 
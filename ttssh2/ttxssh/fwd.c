@@ -726,6 +726,14 @@ static void read_local_connection(PTInstVar pvar, int channel_num)
 			}
 		}
 
+		// SSH̑ML[l܂ĂԂ́Aǂݏo~߂B
+		// L[󂢂 FWD_resume_local_connections() ōĊJB
+		if (SSH_send_queue_is_full(pvar)) {
+			logprintf(LOG_LEVEL_VERBOSE, "%s: channel=%d recv was skipped for send queue",
+				__FUNCTION__, channel_num);
+			return;
+		}
+
 		// M(mubLO[h)
 		amount = recv(channel->local_socket, buf, sizeof(buf), 0);
 
@@ -854,6 +862,27 @@ void FWD_suspend_resume_local_connection(PTInstVar pvar, Channel_t* c, int notif
 
 }
 
+// SSH̑ML[󂢂ƂɁAׂĂ local connection ̎MĊJ
+void FWD_resume_local_connections(PTInstVar pvar)
+{
+	int i;
+
+	if (pvar->fwd_state.accept_wnd == NULL) {
+		return;
+	}
+
+	for (i = 0; i < pvar->fwd_state.num_channels; i++) {
+		FWDChannel *channel = pvar->fwd_state.channels + i;
+
+		if (channel->local_socket != INVALID_SOCKET &&
+		    (channel->status & FWD_BOTH_CONNECTED) == FWD_BOTH_CONNECTED) {
+			PostMessage(pvar->fwd_state.accept_wnd, WM_SOCK_IO,
+				(WPARAM)channel->local_socket,
+				MAKEWPARAM(FD_READ, 0)
+				);
+		}
+	}
+}
 
 static LRESULT CALLBACK accept_wnd_proc(HWND wnd, UINT msg, WPARAM wParam,
                                         LPARAM lParam)
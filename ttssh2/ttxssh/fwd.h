@@ -170,5 +170,6 @@ int FWD_check_local_channel_num(PTInstVar pvar, int local_num);
 int FWD_agent_open(PTInstVar pvar, uint32 remote_channel_num);
 BOOL FWD_agent_forward_confirm(PTInstVar pvar);
 void FWD_suspend_resume_local_connection(PTInstVar pvar, Channel_t* c, int notify);
+void FWD_resume_local_connections(PTInstVar pvar);
 
 #endif
@@ -441,7 +441,7 @@ unsigned char *kex_dh_hash(const EVP_MD *evp_md,
 	if (md == NULL)
 		goto error;
 
-	b = buffer_init();
+	b = buffer_init_secret();
 	buffer_put_string(b, client_version_string, strlen(client_version_string));
 	buffer_put_string(b, server_version_string, strlen(server_version_string));
 
@@ -504,7 +504,7 @@ unsigned char *kex_dh_gex_hash(const EVP_MD *evp_md,
 	if (md == NULL)
 		goto error;
 
-	b = buffer_init();
+	b = buffer_init_secret();
 	buffer_put_string(b, client_version_string, strlen(client_version_string));
 	buffer_put_string(b, server_version_string, strlen(server_version_string));
 
@@ -572,7 +572,7 @@ unsigned char *kex_ecdh_hash(const EVP_MD *evp_md,
 	if (md == NULL)
 		goto error;
 
-	b = buffer_init();
+	b = buffer_init_secret();
 	buffer_put_string(b, client_version_string, strlen(client_version_string));
 	buffer_put_string(b, server_version_string, strlen(server_version_string));
 
@@ -657,7 +657,7 @@ static u_char *derive_key(int id, int need, u_char *hash, BIGNUM *shared_secret,
 	if (digest == NULL)
 		goto skip;
 
-	b = buffer_init();
+	b = buffer_init_secret();
 	if (b == NULL)
 		goto skip;
 
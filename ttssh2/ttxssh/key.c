@@ -492,7 +492,7 @@ static int ssh_ed25519_verify(Key *key, unsigned char *signature, unsigned int s
 	char *bptr;
 
 	ret = -1;
-	b = buffer_init();
+	b = buffer_init_secret();
 	if (b == NULL)
 		goto error;
 
@@ -1314,7 +1314,7 @@ int key_to_blob(Key *key, char **blobp, int *lenp)
 	BIGNUM *e = NULL, *n = NULL;
 	BIGNUM *p, *q, *g, *pub_key;
 
-	b = buffer_init();
+	b = buffer_init_secret();
 	sshname = get_ssh2_hostkey_type_name_from_key(key);
 
 	switch (key->type) {
@@ -1538,7 +1538,7 @@ static int ssh_ed25519_sign(Key *key, char **sigp, int *lenp, char *data, int da
 		return -1;
 	}
 	/* encode signature */
-	b = buffer_init();
+	b = buffer_init_secret();
 	buffer_put_cstring(b, "ssh-ed25519");
 	buffer_put_string(b, sig, (int)(smlen - datalen));
 	len = buffer_len(b);
@@ -1562,7 +1562,7 @@ BOOL generate_SSH2_keysign(Key *keypair, char **sigptr, int *siglen, char *data,
 	char *s;
 	int ret;
 
-	msg = buffer_init();
+	msg = buffer_init_secret();
 	if (msg == NULL) {
 		// TODO: error check
 		return FALSE;
@@ -1738,7 +1738,7 @@ BOOL generate_SSH2_keysign(Key *keypair, char **sigptr, int *siglen, char *data,
 			goto error;
 		}
 
-		buf2 = buffer_init();
+		buf2 = buffer_init_secret();
 		if (buf2 == NULL) {
 			// TODO: error check
 			goto error;
@@ -1794,7 +1794,7 @@ BOOL get_SSH2_publickey_blob(PTInstVar pvar, buffer_t **blobptr, int *bloblen)
 	BIGNUM *e = NULL, *n = NULL;
 	BIGNUM *p, *q, *g, *pub_key;
 
-	msg = buffer_init();
+	msg = buffer_init_secret();
 	if (msg == NULL) {
 		// TODO: error check
 		return FALSE;
@@ -2518,7 +2518,7 @@ static void client_global_hostkeys_private_confirm(PTInstVar pvar, int type, u_i
 	len = pvar->ssh_state.payloadlen;
 	len--;   // type 
 
-	bsig = buffer_init();
+	bsig = buffer_init_secret();
 	if (bsig == NULL)
 		goto error;
 	cp = buffer_append_space(bsig, len);
@@ -2541,7 +2541,7 @@ static void client_global_hostkeys_private_confirm(PTInstVar pvar, int type, u_i
 		goto error;
 	}
 
-	b = buffer_init();
+	b = buffer_init_secret();
 	if (b == NULL)
 		goto error;
 
@@ -2618,7 +2618,7 @@ int update_client_input_hostkeys(PTInstVar pvar, char *dataptr, int datalen)
 	if (ctx == NULL)
 		goto error;
 
-	b = buffer_init();
+	b = buffer_init_secret();
 	if (b == NULL)
 		goto error;
 
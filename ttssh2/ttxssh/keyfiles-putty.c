@@ -72,7 +72,7 @@ BOOL ppk_read_header(FILE * fp, char *header)
 // from sshpubk.c (ver 0.74)
 char *ppk_read_body(FILE * fp)
 {
-	buffer_t *buf = buffer_init();
+	buffer_t *buf = buffer_init_secret();
 
 	while (1) {
 		int c = fgetc(fp);
@@ -405,11 +405,11 @@ static Key *read_SSH2_private2_key(PTInstVar pvar,
 	struct sshcipher_ctx *cc = NULL;
 	int ret;
 
-	blob = buffer_init();
-	b = buffer_init();
-	kdf = buffer_init();
-	encoded = buffer_init();
-	copy_consumed = buffer_init();
+	blob = buffer_init_secret();
+	b = buffer_init_secret();
+	kdf = buffer_init_secret();
+	encoded = buffer_init_secret();
+	copy_consumed = buffer_init_secret();
 
 	if (blob == NULL || b == NULL || kdf == NULL || encoded == NULL || copy_consumed == NULL)
 		goto error;
@@ -829,7 +829,7 @@ Key *read_SSH2_PuTTY_private_key(PTInstVar pvar,
 	buffer_t *public_blob = NULL, *private_blob = NULL, *cipher_mac_keys_blob = NULL;
 	unsigned char *cipherkey = NULL, *cipheriv = NULL, *mackey = NULL;
 	unsigned int cipherkey_len, cipheriv_len, mackey_len;
-	buffer_t *passphrase_salt = buffer_init();
+	buffer_t *passphrase_salt = buffer_init_secret();
 	const struct ssh2cipher *ciphertype;
 	int lines, len;
 	ppk_argon2_parameters params;
@@ -932,7 +932,7 @@ Key *read_SSH2_PuTTY_private_key(PTInstVar pvar,
 	}
 	lines = atoi(b);
 	free(b);
-	public_blob = buffer_init();
+	public_blob = buffer_init_secret();
 	if (!ppk_read_blob(fp, lines, public_blob)) {
 		strncpy_s(errmsg, errmsg_len, "file format error", _TRUNCATE);
 		goto error;
@@ -1053,7 +1053,7 @@ Key *read_SSH2_PuTTY_private_key(PTInstVar pvar,
 	}
 	lines = atoi(b);
 	free(b);
-	private_blob = buffer_init();
+	private_blob = buffer_init_secret();
 	if (!ppk_read_blob(fp, lines, private_blob)) {
 		strncpy_s(errmsg, errmsg_len, "file format error", _TRUNCATE);
 		goto error;
@@ -1077,7 +1077,7 @@ Key *read_SSH2_PuTTY_private_key(PTInstVar pvar,
 	}
 
 	// derive key, iv, mackey
-	cipher_mac_keys_blob = buffer_init();
+	cipher_mac_keys_blob = buffer_init_secret();
 	ssh2_ppk_derive_keys(fmt_version, ciphertype,
 	                     passphrase,
 	                     cipher_mac_keys_blob,
@@ -1118,7 +1118,7 @@ Key *read_SSH2_PuTTY_private_key(PTInstVar pvar,
 		buffer_t *macdata;
 		int i;
 
-		macdata = buffer_init();
+		macdata = buffer_init_secret();
 		buffer_put_cstring(macdata, get_ssh2_hostkey_type_name(result->type));
 		buffer_put_cstring(macdata, encryption);
 		buffer_put_cstring(macdata, comment);
@@ -1459,8 +1459,8 @@ Key *read_SSH2_SECSH_private_key(PTInstVar pvar,
 	result->dsa = NULL;
 	result->ecdsa = NULL;
 
-	blob = buffer_init();
-	blob2 = buffer_init();
+	blob = buffer_init_secret();
+	blob2 = buffer_init_secret();
 
 	// parse keyfile & decode blob
 	{
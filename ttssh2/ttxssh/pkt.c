@@ -48,27 +48,38 @@ void PKT_init(PTInstVar pvar)
 	pvar->pkt_state.predecrypted_packet = FALSE;
 }
 
-/* Read some data, leave no more than up_to_amount bytes in the buffer,
+/* Read some data, leave at least up_to_amount bytes of room in the buffer,
    return the number of bytes read or -1 on error or blocking. */
 static int recv_data(PTInstVar pvar, unsigned long up_to_amount)
 {
 	int amount_read;
+	char *tail;
 
-	/* Shuffle data to the start of the buffer */
-	if (pvar->pkt_state.datastart != 0) {
+	// MpPbg̓obt@ł̂܂ܕAyC[hobt@
+	// ڎQƂĂBȑO͌Ă΂邽тɖf[^obt@̐擪
+	// memmove ĂA̋󂫂ȂȂƂl߂悤ɂB
+	// l߂̂͏r̃pPbg̒fЂȂ̂ŁARs[ʂ͏B
+	if (pvar->pkt_state.datalen == 0) {
+		pvar->pkt_state.datastart = 0;
+	}
+	else if (pvar->pkt_state.datastart != 0 &&
+	    pvar->pkt_state.datastart + up_to_amount > pvar->pkt_state.buflen) {
 		memmove(pvar->pkt_state.buf,
 		        pvar->pkt_state.buf + pvar->pkt_state.datastart,
 		        pvar->pkt_state.datalen);
 		pvar->pkt_state.datastart = 0;
 	}
 
-	buf_ensure_size(&pvar->pkt_state.buf, &pvar->pkt_state.buflen, up_to_amount);
+	// l߂px邽߁AKvʂ2{mۂĂ
+	buf_ensure_size_growing(&pvar->pkt_state.buf, &pvar->pkt_state.buflen,
+	                        pvar->pkt_state.datastart + up_to_amount);
 
 	_ASSERT(pvar->pkt_state.buf != NULL);
 
-	amount_read = (pvar->Precv) (pvar->socket,
-	                             pvar->pkt_state.buf + pvar->pkt_state.datalen,
-	                             up_to_amount - pvar->pkt_state.datalen,
+	// ̋󂫑ŜɓǂݍŁArecv() ̌Ăяo񐔂炷
+	tail = pvar->pkt_state.buf + pvar->pkt_state.datastart + pvar->pkt_state.datalen;
+	amount_read = (pvar->Precv) (pvar->socket, tail,
+	                             pvar->pkt_state.buflen - pvar->pkt_state.datastart - pvar->pkt_state.datalen,
 	                             0);
 
 	if (amount_read > 0) {
@@ -77,7 +88,7 @@ static int recv_data(PTInstVar pvar, unsigned long up_to_amount)
 			int i;
 
 			for (i = 0; i < amount_read; i++) {
-				if (pvar->pkt_state.buf[pvar->pkt_state.datalen + i] == '\n') {
+				if (tail[i] == '\n') {
 					pvar->pkt_state.seen_newline = 1;
 				}
 			}
@@ -150,16 +161,17 @@ int PKT_recv(PTInstVar pvar, char *buf, int buflen)
 			 * We're looking for the initial ID string and either we've seen the
 			 * terminating newline, or we've exceeded the limit at which we should see a newline.
 			 */
+			char *data = pvar->pkt_state.buf + pvar->pkt_state.datastart;
 			unsigned int i;
 
-			for (i = 0; pvar->pkt_state.buf[i] != '\n' && i < pvar->pkt_state.datalen; i++) {
+			for (i = 0; data[i] != '\n' && i < pvar->pkt_state.datalen; i++) {
 			}
-			if (pvar->pkt_state.buf[i] == '\n') {
+			if (data[i] == '\n') {
 				i++;
 			}
 
 			// SSHT[õo[W`FbNs
-			if (SSH_handle_server_ID(pvar, pvar->pkt_state.buf, i)) {
+			if (SSH_handle_server_ID(pvar, data, i)) {
 				pvar->pkt_state.seen_server_ID = 1;
 
 				if (SSHv2(pvar)) {
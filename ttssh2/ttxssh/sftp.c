@@ -190,14 +190,22 @@ static void sftp_buffer_free(buffer_t *message)
 static void sftp_send_msg(PTInstVar pvar, Channel_t *c, buffer_t *msg)
 {
 	char *p;
-	int len;
+	unsigned int len, n;
 
 	len = buffer_len(msg);
 	p = buffer_ptr(msg);
 	// ŏɃbZ[WTCYi[B
 	set_uint32(p, len - 4);
 	// yC[h̑MB
-	SSH2_send_channel_data(pvar, c, p, len, 0);
+	// WRITEv̓`l̍őpPbg𒴂邱Ƃ̂ŁAđB
+	while (len > 0) {
+		n = len;
+		if (c->remote_maxpacket > 0 && n > c->remote_maxpacket)
+			n = c->remote_maxpacket;
+		SSH2_send_channel_data(pvar, c, p, n, 0);
+		p += n;
+		len -= n;
+	}
 }
 
 // T[oMSFTPpPbgobt@Ɋi[B
@@ -250,10 +258,10 @@ void sftp_do_init(PTInstVar pvar, Channel_t *c)
 	buffer_t *msg;
 
 	// SFTPǗ\̂̏
-	memset(&c->sftp, 0, sizeof(c->sftp));
+	// `l쐬Ƀ[NAĂBlSVG[VOɗvꂽ](xfer)͎cB
 	c->sftp.state = SFTP_INIT;
-	c->sftp.transfer_buflen = DEFAULT_COPY_BUFLEN;
-	c->sftp.num_requests = DEFAULT_NUM_REQUESTS;
+	c->sftp.transfer_buflen = pvar->settings.SftpBufferSize;
+	c->sftp.num_requests = pvar->settings.SftpRequests;
 	c->sftp.exts = 0;
 	c->sftp.limit_kbps = 0;
 
@@ -407,6 +415,415 @@ error:
 	return (filename);
 }
 
+//
+// get/put ̓]
+// based on do_download()/do_upload()#sftp-client.c(OpenSSH 6.0)
+//
+// READ/WRITE v num_requests ܂ŉ҂ɑAԂ邽тɎ𑗂B
+// 1vƂɉ҂Ȃ̂ŁAx̑傫łX[vbgɂB
+//
+
+// ]̏(SFTP_XFER_STATUS_*)B}N]̏I҂߂ɎgB
+static int sftp_xfer_status = SFTP_XFER_STATUS_IDLE;
+
+static sftp_request_t *sftp_xfer_find_req(sftp_xfer_t *x, unsigned int id)
+{
+	unsigned int i;
+
+	for (i = 0; i < x->inflight; i++) {
+		if (x->reqs[i].id == id)
+			return &x->reqs[i];
+	}
+	return NULL;
+}
+
+static void sftp_xfer_add_req(sftp_xfer_t *x, unsigned int id, unsigned long long offset, unsigned int len)
+{
+	sftp_request_t *r = &x->reqs[x->inflight++];
+
+	r->id = id;
+	r->offset = offset;
+	r->len = len;
+}
+
+static void sftp_xfer_del_req(sftp_xfer_t *x, sftp_request_t *r)
+{
+	// ͖Ȃ̂ŁA̗vŖ߂
+	*r = x->reqs[--x->inflight];
+}
+
+static void sftp_xfer_cleanup(Channel_t *c)
+{
+	sftp_xfer_t *x = &c->sftp.xfer;
+
+	if (x->fp != NULL) {
+		fclose(x->fp);
+		x->fp = NULL;
+	}
+	free(x->handle);
+	x->handle = NULL;
+	x->handle_len = 0;
+	free(x->reqs);
+	x->reqs = NULL;
+	free(x->iobuf);
+	x->iobuf = NULL;
+	x->inflight = 0;
+	if (x->dir != SFTP_XFER_NONE) {
+		sftp_xfer_status = x->error ? SFTP_XFER_STATUS_ERROR : SFTP_XFER_STATUS_IDLE;
+	}
+	x->dir = SFTP_XFER_NONE;
+}
+
+static void sftp_send_open(PTInstVar pvar, Channel_t *c, char *path, unsigned int pflags)
+{
+	buffer_t *msg;
+	unsigned int id;
+
+	id = c->sftp.msg_id++;
+	sftp_buffer_alloc(&msg);
+	buffer_put_char(msg, SSH2_FXP_OPEN);
+	buffer_put_int(msg, id);
+	buffer_put_string(msg, path, strlen(path));
+	buffer_put_int(msg, pflags);
+	buffer_put_int(msg, 0);  // attrs(flags)
+	sftp_send_msg(pvar, c, msg);
+	sftp_syslog(pvar, "Sent message SSH2_FXP_OPEN I:%u P:%s M:0x%04x", id, path, pflags);
+	sftp_buffer_free(msg);
+}
+
+static void sftp_send_read(PTInstVar pvar, Channel_t *c, unsigned int id, unsigned long long offset, unsigned int len)
+{
+	sftp_xfer_t *x = &c->sftp.xfer;
+	buffer_t *msg;
+
+	sftp_buffer_alloc(&msg);
+	buffer_put_char(msg, SSH2_FXP_READ);
+	buffer_put_int(msg, id);
+	buffer_put_string(msg, x->handle, x->handle_len);
+	buffer_put_int64(msg, offset);
+	buffer_put_int(msg, len);
+	sftp_send_msg(pvar, c, msg);
+	sftp_buffer_free(msg);
+}
+
+static void sftp_send_write(PTInstVar pvar, Channel_t *c, unsigned int id, unsigned long long offset, char *data, unsigned int len)
+{
+	sftp_xfer_t *x = &c->sftp.xfer;
+	buffer_t *msg;
+
+	sftp_buffer_alloc(&msg);
+	buffer_put_char(msg, SSH2_FXP_WRITE);
+	buffer_put_int(msg, id);
+	buffer_put_string(msg, x->handle, x->handle_len);
+	buffer_put_int64(msg, offset);
+	buffer_put_string(msg, data, len);
+	sftp_send_msg(pvar, c, msg);
+	sftp_buffer_free(msg);
+}
+
+static void sftp_xfer_finish(PTInstVar pvar, Channel_t *c)
+{
+	sftp_xfer_t *x = &c->sftp.xfer;
+	DWORD elapsed;
+
+	elapsed = GetTickCount() - x->start_tick;
+	if (x->error) {
+		sftp_console_message(pvar, c, "%s: transfer aborted after %I64u bytes",
+		                     x->remotefile, x->done);
+	} else {
+		sftp_console_message(pvar, c, "%s: %I64u bytes in %lu.%03lu sec (%I64u KB/s)",
+		                     x->remotefile, x->done, elapsed / 1000, elapsed % 1000,
+		                     elapsed > 0 ? x->done * 1000 / 1024 / elapsed : 0);
+	}
+	sftp_xfer_cleanup(c);
+	c->sftp.state = SFTP_REALPATH;
+}
+
+static void sftp_xfer_close(PTInstVar pvar, Channel_t *c)
+{
+	sftp_xfer_t *x = &c->sftp.xfer;
+	unsigned int id;
+
+	if (x->handle == NULL) {
+		sftp_xfer_finish(pvar, c);
+		return;
+	}
+	id = c->sftp.msg_id++;
+	sftp_send_string_request(pvar, c, id, SSH2_FXP_CLOSE, x->handle, x->handle_len);
+	c->sftp.state = SFTP_XFER_CLOSE;
+}
+
+// ҂ num_requests ɂȂ܂ READ/WRITE v𑗂B
+// ̂ȂA҂ȂȂt@CB
+static void sftp_xfer_fill(PTInstVar pvar, Channel_t *c)
+{
+	sftp_xfer_t *x = &c->sftp.xfer;
+	unsigned int id, len;
+	size_t n;
+
+	while (!x->error && !x->eof && x->inflight < c->sftp.num_requests) {
+		if (SSH_send_queue_is_full(pvar)) {
+			// ML[󂢂 sftp_resume_transfer() ő𑗂
+			return;
+		}
+		if (x->dir == SFTP_XFER_GET) {
+			// TCYĂ΁A̐͗vȂ
+			if (x->size_known && x->offset >= x->size)
+				break;
+			len = c->sftp.transfer_buflen;
+			id = c->sftp.msg_id++;
+			sftp_send_read(pvar, c, id, x->offset, len);
+		} else {
+			n = fread(x->iobuf, 1, c->sftp.transfer_buflen, x->fp);
+			if (n == 0) {
+				if (ferror(x->fp)) {
+					sftp_console_message(pvar, c, "Couldn't read from local file \"%s\"", x->localfile);
+					x->error = TRUE;
+				}
+				x->eof = TRUE;
+				break;
+			}
+			len = (unsigned int)n;
+			id = c->sftp.msg_id++;
+			sftp_send_write(pvar, c, id, x->offset, x->iobuf, len);
+		}
+		sftp_xfer_add_req(x, id, x->offset, len);
+		x->offset += len;
+	}
+
+	if (x->inflight == 0) {
+		sftp_xfer_close(pvar, c);
+	}
+}
+
+// ML[󂢂ƂɌĂ΂A~߂Ă READ/WRITE v̑MĊJB
+void sftp_resume_transfer(PTInstVar pvar, Channel_t *c)
+{
+	if (c->sftp.state == SFTP_XFER_DATA) {
+		sftp_xfer_fill(pvar, c);
+	}
+}
+
+// ]JnB[Jt@C͌ĂяoŊJĂB
+static void sftp_xfer_begin(PTInstVar pvar, Channel_t *c)
+{
+	sftp_xfer_t *x = &c->sftp.xfer;
+	unsigned int pflags;
+
+	x->reqs = calloc(c->sftp.num_requests, sizeof(sftp_request_t));
+	if (x->dir == SFTP_XFER_PUT) {
+		x->iobuf = malloc(c->sftp.transfer_buflen);
+	}
+	if (x->reqs == NULL || (x->dir == SFTP_XFER_PUT && x->iobuf == NULL)) {
+		sftp_syslog(pvar, "%s: memory allocation failed", __FUNCTION__);
+		x->error = TRUE;
+		sftp_xfer_cleanup(c);
+		return;
+	}
+	x->start_tick = GetTickCount();
+
+	if (x->dir == SFTP_XFER_GET) {
+		sftp_console_message(pvar, c, "Fetching %s to %s", x->remotefile, x->localfile);
+		pflags = SSH2_FXF_READ;
+	} else {
+		sftp_console_message(pvar, c, "Uploading %s to %s", x->localfile, x->remotefile);
+		pflags = SSH2_FXF_WRITE | SSH2_FXF_CREAT;
+		if (!x->resume)
+			pflags |= SSH2_FXF_TRUNC;
+	}
+	sftp_send_open(pvar, c, x->remotefile, pflags);
+	c->sftp.state = SFTP_XFER_OPEN;
+}
+
+// get/put \񂷂BSFTP̃lSVG[Vł΁AIĂJnB
+// localsize  get ł̓[J̊TCY(ĊJʒu)Aput ł͑t@C̃TCYB
+int sftp_start_transfer(PTInstVar pvar, Channel_t *c, enum sftp_xfer_dir dir, FILE *fp,
+                        const char *localfile, const char *remotefile, int resume, unsigned long long localsize)
+{
+	sftp_xfer_t *x = &c->sftp.xfer;
+
+	if (x->dir != SFTP_XFER_NONE) {
+		sftp_console_message(pvar, c, "Another transfer is in progress.");
+		return FALSE;
+	}
+
+	memset(x, 0, sizeof(*x));
+	x->dir = dir;
+	x->fp = fp;
+	x->resume = resume;
+	strncpy_s(x->localfile, sizeof(x->localfile), localfile, _TRUNCATE);
+	strncpy_s(x->remotefile, sizeof(x->remotefile), remotefile, _TRUNCATE);
+	if (dir == SFTP_XFER_GET) {
+		x->offset = localsize;
+	} else {
+		x->size = localsize;
+	}
+
+	sftp_xfer_status = SFTP_XFER_STATUS_BUSY;
+	if (c->sftp.state == SFTP_REALPATH) {
+		sftp_xfer_begin(pvar, c);
+	}
+	return TRUE;
+}
+
+// ]̏ԂԂB
+int sftp_get_transfer_status(void)
+{
+	return sftp_xfer_status;
+}
+
+// OPEN/FSTAT/READ/WRITE/CLOSE ̉B
+static void sftp_xfer_recv(PTInstVar pvar, Channel_t *c, buffer_t *msg)
+{
+	sftp_xfer_t *x = &c->sftp.xfer;
+	sftp_request_t *r, req;
+	unsigned int type, id, status, flags, len;
+	unsigned long long rsize = 0;
+	int rsize_known = FALSE;
+	char *data;
+	int hlen;
+
+	type = buffer_get_char(msg);
+	id = buffer_get_int(msg);
+
+	switch (c->sftp.state) {
+	case SFTP_XFER_OPEN:
+		if (type == SSH2_FXP_HANDLE) {
+			x->handle = buffer_get_string_msg(msg, &hlen);
+			x->handle_len = hlen;
+			// get ł͐î߂ɁAput ̍ĊJł̓[g̊TCYm邽߂ɃTCY𓾂
+			if (x->dir == SFTP_XFER_GET || x->resume) {
+				id = c->sftp.msg_id++;
+				sftp_send_string_request(pvar, c, id, SSH2_FXP_FSTAT, x->handle, x->handle_len);
+				c->sftp.state = SFTP_XFER_FSTAT;
+			} else {
+				c->sftp.state = SFTP_XFER_DATA;
+				sftp_xfer_fill(pvar, c);
+			}
+		} else {
+			status = (type == SSH2_FXP_STATUS) ? buffer_get_int(msg) : SSH2_FX_BAD_MESSAGE;
+			sftp_console_message(pvar, c, "Couldn't open remote file \"%s\": %s", x->remotefile, fx2txt(status));
+			x->error = TRUE;
+			sftp_xfer_finish(pvar, c);
+		}
+		break;
+
+	case SFTP_XFER_FSTAT:
+		if (type == SSH2_FXP_ATTRS) {
+			flags = buffer_get_int(msg);
+			if (flags & SSH2_FILEXFER_ATTR_SIZE) {
+				rsize = buffer_get_int64(msg);
+				rsize_known = TRUE;
+			}
+		} else {
+			sftp_syslog(pvar, "Couldn't fstat remote file \"%s\"", x->remotefile);
+		}
+
+		if (x->dir == SFTP_XFER_GET) {
+			x->size = rsize;
+			x->size_known = rsize_known;
+			if (x->resume && rsize_known && x->offset > rsize) {
+				sftp_console_message(pvar, c, "Unable to resume download of \"%s\": local file is larger than remote",
+				                     x->remotefile);
+				x->error = TRUE;
+			}
+		} else if (rsize_known) {
+			if (rsize > x->size) {
+				sftp_console_message(pvar, c, "Unable to resume upload of \"%s\": remote file is larger than local",
+				                     x->localfile);
+				x->error = TRUE;
+			} else {
+				x->offset = rsize;
+				_fseeki64(x->fp, rsize, SEEK_SET);
+			}
+		}
+		if (x->offset > 0 && !x->error) {
+			sftp_console_message(pvar, c, "Resuming at offset %I64u", x->offset);
+		}
+		c->sftp.state = SFTP_XFER_DATA;
+		sftp_xfer_fill(pvar, c);
+		break;
+
+	case SFTP_XFER_DATA:
+		r = sftp_xfer_find_req(x, id);
+		if (r == NULL) {
+			sftp_syslog(pvar, "Unexpected reply %u", id);
+			break;
+		}
+		req = *r;
+		sftp_xfer_del_req(x, r);
+
+		if (type == SSH2_FXP_DATA && x->dir == SFTP_XFER_GET) {
+			len = buffer_get_int(msg);
+			data = buffer_tail_ptr(msg);
+			if (len > req.len || len > (unsigned int)buffer_remain_len(msg)) {
+				sftp_console_message(pvar, c, "Received more data than asked for %u > %u", len, req.len);
+				x->error = TRUE;
+			} else {
+				// ͂قڏԂǂɓ͂̂ŁAʒuꂽƂV[N
+				if (x->filepos != req.offset) {
+					_fseeki64(x->fp, req.offset, SEEK_SET);
+				}
+				if (fwrite(data, 1, len, x->fp) != len) {
+					sftp_console_message(pvar, c, "Couldn't write to local file \"%s\"", x->localfile);
+					x->error = TRUE;
+				}
+				x->filepos = req.offset + len;
+				x->done += len;
+			}
+
+			// vZ΁Ac߂ėv
+			if (len < req.len && !x->error) {
+				id = c->sftp.msg_id++;
+				sftp_send_read(pvar, c, id, req.offset + len, req.len - len);
+				sftp_xfer_add_req(x, id, req.offset + len, req.len - len);
+			}
+		} else if (type == SSH2_FXP_STATUS) {
+			status = buffer_get_int(msg);
+			if (status == SSH2_FX_OK && x->dir == SFTP_XFER_PUT) {
+				x->done += req.len;
+			} else if (status == SSH2_FX_EOF && x->dir == SFTP_XFER_GET) {
+				x->eof = TRUE;
+			} else {
+				sftp_console_message(pvar, c, "Couldn't %s \"%s\": %s",
+				                     x->dir == SFTP_XFER_GET ? "read from remote file" : "write to remote file",
+				                     x->remotefile, fx2txt(status));
+				x->error = TRUE;
+			}
+		} else {
+			sftp_syslog(pvar, "Unexpected reply type %u", type);
+			x->error = TRUE;
+		}
+		sftp_xfer_fill(pvar, c);
+		break;
+
+	case SFTP_XFER_CLOSE:
+		if (type == SSH2_FXP_STATUS) {
+			status = buffer_get_int(msg);
+			if (status != SSH2_FX_OK) {
+				sftp_console_message(pvar, c, "Couldn't close file: %s", fx2txt(status));
+				x->error = TRUE;
+			}
+		}
+		sftp_xfer_finish(pvar, c);
+		break;
+
+	default:
+		break;
+	}
+}
+
+// `l폜̌n
+void sftp_channel_free(Channel_t *c)
+{
+	// ]Ƀ`lꂽƂ͎sƂ
+	c->sftp.xfer.error = TRUE;
+	sftp_xfer_cleanup(c);
+	free(c->sftp.rbuf);
+	c->sftp.rbuf = NULL;
+	c->sftp.rbuf_len = c->sftp.rbuf_size = 0;
+}
+
 
 u_int
 sftp_proto_version(struct sftp *conn)
@@ -427,7 +844,7 @@ help(void)
 	    "df [-hi] [path]                    Display statistics for current directory or\r\n"
 	    "                                   filesystem containing 'path'\r\n"
 	    "exit                               Quit sftp\r\n"
-	    "get [-Ppr] remote [local]          Download file\r\n"
+	    "get [-a] remote [local]            Download file (-a to resume)\r\n"
 	    "help                               Display this help text\r\n"
 	    "lcd path                           Change local directory to 'path'\r\n"
 	    "lls [ls-options [path]]            Display local directory listing\r\n"
@@ -438,7 +855,7 @@ help(void)
 	    "lumask umask                       Set local umask to 'umask'\r\n"
 	    "mkdir path                         Create remote directory\r\n"
 	    "progress                           Toggle display of progress meter\r\n"
-	    "put [-Ppr] local [remote]          Upload file\r\n"
+	    "put [-a] local [remote]            Upload file (-a to resume)\r\n"
 	    "pwd                                Display remote working directory\r\n"
 	    "quit                               Quit sftp\r\n"
 	    "rename oldpath newpath             Rename remote file\r\n"
@@ -613,7 +1030,7 @@ makeargv(const char *arg, int *argcp, int sloppy, char *lastquote,
 }
 
 static int parse_args(const char **cpp, int *pflag, int *rflag, int *lflag, int *iflag,
-    int *hflag, int *sflag, unsigned long *n_arg, char **path1, char **path2)
+    int *hflag, int *sflag, int *aflag, unsigned long *n_arg, char **path1, char **path2)
 {
     const char *cmd, *cp = *cpp;
     char *cp2 = NULL, **argv;
@@ -657,30 +1074,34 @@ static int parse_args(const char **cpp, int *pflag, int *rflag, int *lflag, int
 	}
 
 	/* Get arguments and parse flags */
-	*lflag = *pflag = *rflag = *hflag = *n_arg = 0;
+	*lflag = *pflag = *rflag = *hflag = *aflag = *n_arg = 0;
 	*path1 = *path2 = NULL;
 	optidx = 1;
 	switch (cmdnum) {
-#if 0
 	case I_GET:
 	case I_PUT:
-		if ((optidx = parse_getput_flags(cmd, argv, argc,
-		    pflag, rflag)) == -1)
-			return -1;
+		// -a: r܂œ]ꂽt@C̑]
+		for (; optidx < argc && argv[optidx][0] == '-'; optidx++) {
+			if (strcmp(argv[optidx], "-a") == 0) {
+				*aflag = 1;
+			} else {
+				sftp_console_message(g_pvar, g_channel, "%s: Invalid flag %s", cmd, argv[optidx]);
+				return -1;
+			}
+		}
 		/* Get first pathname (mandatory) */
 		if (argc - optidx < 1) {
-			error("You must specify at least one path after a "
-			    "%s command.", cmd);
+			sftp_console_message(g_pvar, g_channel,
+				"You must specify at least one path after a %s command.", cmd);
 			return -1;
 		}
-		*path1 = xstrdup(argv[optidx]);
+		*path1 = _strdup(argv[optidx]);
 		/* Get second pathname (optional) */
 		if (argc - optidx > 1) {
-			*path2 = xstrdup(argv[optidx + 1]);
-			/* Destination is not globbed */
-			undo_glob_escape(*path2);
+			*path2 = _strdup(argv[optidx + 1]);
 		}
 		break;
+#if 0
 	case I_LINK:
 		if ((optidx = parse_link_flags(cmd, argv, argc, sflag)) == -1)
 			return -1;
@@ -796,7 +1217,7 @@ static LRESULT CALLBACK EditProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lPa
 	char buf[512];
 	char *cmd;
     char *path1, *path2, *tmp = NULL;
-    int pflag = 0, rflag = 0, lflag = 0, iflag = 0, hflag = 0, sflag = 0;
+    int pflag = 0, rflag = 0, lflag = 0, iflag = 0, hflag = 0, sflag = 0, aflag = 0;
     int cmdnum, i = 0;
     unsigned long n_arg = 0;
 	//Attrib a, *aa;
@@ -828,7 +1249,7 @@ cmd_parsed:
 	path1 = path2 = NULL;
 	cmd = buf;
 	cmdnum = parse_args((const char **)&cmd, &pflag, &rflag, &lflag, &iflag, &hflag,
-		&sflag, &n_arg, &path1, &path2);
+		&sflag, &aflag, &n_arg, &path1, &path2);
 
 	if (iflag != 0)
 		err_abort = 0;
@@ -844,13 +1265,15 @@ cmd_parsed:
 		/* Unrecognized command */
 		err = -1;
 		break;
-#if 0
 	case I_GET:
-		err = process_get(conn, path1, path2, *pwd, pflag, rflag);
+		if (!SSH_sftp_transfer(g_pvar, SFTP_XFER_GET, path2, path1, aflag))
+			err = -1;
 		break;
 	case I_PUT:
-		err = process_put(conn, path1, path2, *pwd, pflag, rflag);
+		if (!SSH_sftp_transfer(g_pvar, SFTP_XFER_PUT, path1, path2, aflag))
+			err = -1;
 		break;
+#if 0
 	case I_RENAME:
 		path1 = make_absolute(path1, *pwd);
 		path2 = make_absolute(path2, *pwd);
@@ -1038,13 +1461,12 @@ cmd_parsed:
 		err = -1;
 	}
 
+	free(path1);
+	free(path2);
+
 #if 0
 	if (g.gl_pathc)
 		globfree(&g);
-	if (path1)
-		xfree(path1);
-	if (path2)
-		xfree(path2);
 
 	/* If an unignored error occurs in batch mode we should abort. */
 	if (err_abort && err != 0)
@@ -1137,17 +1559,10 @@ static LRESULT CALLBACK OnSftpConsoleDlgProc(HWND hDlgWnd, UINT msg, WPARAM wp,
 }
 
 // SFTPM -Xe[g}V[-
-void sftp_response(PTInstVar pvar, Channel_t *c, unsigned char *data, unsigned int buflen)
+static void sftp_dispatch(PTInstVar pvar, Channel_t *c, buffer_t *msg)
 {
-	buffer_t *msg;
 	HWND hDlgWnd;
 
-	/*
-	 * Allocate buffer
-	 */
-	sftp_buffer_alloc(&msg);
-	sftp_get_msg(pvar, c, data, buflen, &msg);
-
 	if (c->sftp.state == SFTP_INIT) {
 		// O[oϐɕۑB
 		g_pvar = pvar;
@@ -1169,9 +1584,68 @@ void sftp_response(PTInstVar pvar, Channel_t *c, unsigned char *data, unsigned i
 	} else if (c->sftp.state == SFTP_CONNECTED) {
 		char *remote_path;
 		remote_path = sftp_do_realpath_recv(pvar, c, msg);
+		free(remote_path);
 
 		c->sftp.state = SFTP_REALPATH;
 
+		// lSVG[Vɗvꂽ]ΊJn
+		if (c->sftp.xfer.dir != SFTP_XFER_NONE) {
+			sftp_xfer_begin(pvar, c);
+		}
+
+	} else if (c->sftp.state != SFTP_REALPATH) {
+		sftp_xfer_recv(pvar, c, msg);
+
+	}
+}
+
+void sftp_response(PTInstVar pvar, Channel_t *c, unsigned char *data, unsigned int buflen)
+{
+	buffer_t *msg;
+	unsigned int msg_len, pos, newsize;
+	unsigned char *p;
+
+	// 1̃`lf[^ɕSFTPbZ[WĂA1̃bZ[W
+	// ̃`lf[^ɕē͂肷̂ŁA߂Ă1oB
+	if (c->sftp.rbuf_len + buflen > c->sftp.rbuf_size) {
+		newsize = c->sftp.rbuf_size ? c->sftp.rbuf_size : 8192;
+		while (newsize < c->sftp.rbuf_len + buflen)
+			newsize *= 2;
+		p = realloc(c->sftp.rbuf, newsize);
+		if (p == NULL) {
+			sftp_syslog(pvar, "%s: realloc failed", __FUNCTION__);
+			return;
+		}
+		c->sftp.rbuf = p;
+		c->sftp.rbuf_size = newsize;
+	}
+	memcpy(c->sftp.rbuf + c->sftp.rbuf_len, data, buflen);
+	c->sftp.rbuf_len += buflen;
+
+	/*
+	 * Allocate buffer
+	 */
+	sftp_buffer_alloc(&msg);
+
+	pos = 0;
+	while (c->sftp.rbuf_len - pos >= 4) {
+		msg_len = get_uint32(c->sftp.rbuf + pos);
+		if (msg_len > SFTP_MAX_MSG_LENGTH) {
+			// bZ[W̐؂ڂȂȂ̂ŁAĉ͎Ă
+			sftp_syslog(pvar, "Received message too long %u", msg_len);
+			pos = c->sftp.rbuf_len;
+			break;
+		}
+		if (c->sftp.rbuf_len - pos - 4 < msg_len)
+			break;
+
+		sftp_get_msg(pvar, c, c->sftp.rbuf + pos, msg_len + 4, &msg);
+		sftp_dispatch(pvar, c, msg);
+		pos += msg_len + 4;
+	}
+	if (pos > 0) {
+		memmove(c->sftp.rbuf, c->sftp.rbuf + pos, c->sftp.rbuf_len - pos);
+		c->sftp.rbuf_len -= pos;
 	}
 
 	/*
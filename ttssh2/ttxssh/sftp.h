@@ -106,8 +106,14 @@
 
 #define DEFAULT_COPY_BUFLEN 32768   /* Size of buffer for up/download */
 #define DEFAULT_NUM_REQUESTS    64  /* # concurrent outstanding requests */
+#define MAX_NUM_REQUESTS    1024
 
 void sftp_do_init(PTInstVar pvar, Channel_t *c);
 void sftp_response(PTInstVar pvar, Channel_t *c, unsigned char *data, unsigned int buflen);
+int sftp_start_transfer(PTInstVar pvar, Channel_t *c, enum sftp_xfer_dir dir, FILE *fp,
+                        const char *localfile, const char *remotefile, int resume, unsigned long long localsize);
+void sftp_resume_transfer(PTInstVar pvar, Channel_t *c);
+int sftp_get_transfer_status(void);
+void sftp_channel_free(Channel_t *c);
 
 #endif
@@ -153,11 +153,16 @@ static void start_ssh_heartbeat_thread(PTInstVar pvar);
 void ssh2_channel_send_close(PTInstVar pvar, Channel_t *c);
 static BOOL SSH_agent_response(PTInstVar pvar, Channel_t *c, int local_channel_num, unsigned char *data, unsigned int buflen);
 static void ssh2_scp_get_packetlist(PTInstVar pvar, Channel_t *c, unsigned char **buf, unsigned int *buflen);
+static void ssh2_scp_consume_packetlist(PTInstVar pvar, Channel_t *c, unsigned int buflen);
 static void ssh2_scp_free_packetlist(PTInstVar pvar, Channel_t *c);
 static void get_window_pixel_size(PTInstVar pvar, int *x, int *y);
 static void do_SSH2_dispatch_setup_for_transfer(PTInstVar pvar);
 static void ssh2_prep_userauth(PTInstVar pvar);
 static void ssh2_send_newkeys(PTInstVar pvar);
+static void ssh2_check_rekey(PTInstVar pvar);
+static void ssh2_finish_rekey(PTInstVar pvar);
+static void do_SSH2_adjust_window_size(PTInstVar pvar, Channel_t *c);
+void SSH2_channel_input_eof(PTInstVar pvar, Channel_t *c);
 
 // }N
 #define remained_payload(pvar) ((pvar)->ssh_state.payload + payload_current_offset(pvar))
@@ -230,6 +235,7 @@ static Channel_t *ssh2_channel_new(unsigned int window, unsigned int maxpack,
 	c->local_maxpacket = maxpack;
 	c->remote_window = 0;
 	c->remote_maxpacket = 0;
+	c->window_tick = GetTickCount();
 	c->type = type;
 	c->local_num = local_num;  // alloc_channel()̕ԒlۑĂ
 	c->bufchain = NULL;
@@ -283,6 +289,16 @@ static void ssh2_channel_add_bufchain(PTInstVar pvar, Channel_t *c, unsigned cha
 	// obt@TCY̍vXV(L^p)
 	c->bufchain_amount += buflen;
 
+	//  remote_window ̋󂫂Ɋ֌WȂۑ̂ŁAremote_window 
+	// ܂瑗M([́ASCP/SFTPA|[g])~߂B
+	// ̊ ssh2_finish_rekey() ōĊJB
+	if ((pvar->kex_status & KEX_FLAG_REKEYING) && !pvar->ssh_state.rekey_suspended &&
+	    c->bufchain_amount >= c->remote_window) {
+		pvar->ssh_state.rekey_suspended = TRUE;
+		logprintf(LOG_LEVEL_NOTICE, "%s: channel=%d buffered data reached remote window during rekey (%lu bytes).",
+		          __FUNCTION__, c->self_id, c->bufchain_amount);
+	}
+
 	// remote_window̋󂫂Ȃ̂ŁAlocal connectioñpPbgM
 	// ~woBɒʒm~܂킯ł͂ȂB
 	FWD_suspend_resume_local_connection(pvar, c, FALSE);
@@ -296,6 +312,10 @@ static void ssh2_channel_retry_send_bufchain(PTInstVar pvar, Channel_t *c)
 	unsigned int size;
 	bufchain_t* ch_origin = c->bufchain;
 
+	// ͑Ȃ̂ŁÅ ssh2_finish_rekey() 瑗
+	if (pvar->kex_status & KEX_FLAG_REKEYING)
+		return;
+
 	while (c->bufchain) {
 		// 擪ɑ
 		ch = c->bufchain;
@@ -323,6 +343,12 @@ static void ssh2_channel_retry_send_bufchain(PTInstVar pvar, Channel_t *c)
 	if (ch_origin && c->bufchain == NULL) {
 		FWD_suspend_resume_local_connection(pvar, c, TRUE);
 	}
+
+	// ɕۗEOF́AۑĂf[^𑗂IĂ瑗
+	if (c->bufchain == NULL && (c->state & SSH_CHANNEL_STATE_EOF_PENDING)) {
+		c->state &= ~SSH_CHANNEL_STATE_EOF_PENDING;
+		SSH2_channel_input_eof(pvar, c);
+	}
 }
 
 // channel closeɃ`l\̂Xg֕ԋp
@@ -378,12 +404,23 @@ static void ssh2_channel_delete(Channel_t *c)
 			PTInstVar pvar = c->scp.pvar;
 			ssh2_scp_free_packetlist(pvar, c);
 		}
+		else {
+			int i;
+			for (i = 0; i < SCPSND_BUFFER_NUM; i++) {
+				free(c->scp.sendbuf[i].buf);
+				if (c->scp.sendbuf[i].done != NULL)
+					CloseHandle(c->scp.sendbuf[i].done);
+			}
+		}
 
 		g_scp_sending = FALSE;
 	}
 	if (c->type == TYPE_AGENT) {
 		buffer_free(c->agent_msg);
 	}
+	if (c->type == TYPE_SFTP) {
+		sftp_channel_free(c);
+	}
 
 	memset(c, 0, sizeof(Channel_t));
 	c->used = 0;
@@ -1062,10 +1099,15 @@ static int prep_packet_ssh2(PTInstVar pvar, char *data, unsigned int len, unsign
 		buffer_clear(pvar->decomp_buffer);
 
 		// packet sizepadding菜yC[ĥ݂WJB
-		buffer_decompress(&pvar->ssh_state.decompress_stream,
-		                  pvar->ssh_state.payload,
-		                  pvar->ssh_state.payloadlen,
-		                  pvar->decomp_buffer);
+		if (buffer_decompress(&pvar->ssh_state.decompress_stream,
+		                      pvar->ssh_state.payload,
+		                      pvar->ssh_state.payloadlen,
+		                      pvar->decomp_buffer) == -1) {
+			UTIL_get_lang_msg("MSG_SSH_INVALID_COMPDATA_ERROR", pvar,
+			                  "Invalid compressed data in received packet");
+			notify_fatal_error(pvar, pvar->UIMsg, TRUE);
+			return SSH_MSG_NONE;
+		}
 
 		// |C^̍XVB
 		pvar->ssh_state.payload = buffer_ptr(pvar->decomp_buffer);
@@ -1117,80 +1159,206 @@ unsigned char *begin_send_packet(PTInstVar pvar, int type, int len)
 }
 
 
-// MgC֐̒ǉ
+static void send_packet_error(PTInstVar pvar, char *kind, int code)
+{
+	char buf[256];
+
+	UTIL_get_lang_msg("MSG_SSH_SEND_PKT_ERROR", pvar,
+	                  "A communications error occurred while sending an SSH packet.\n"
+	                  "The connection will close. (%s:%d)");
+	_snprintf_s(buf, sizeof(buf), _TRUNCATE, pvar->UIMsg,
+	            kind, code);
+	notify_fatal_error(pvar, buf, TRUE);
+}
+
+// mubLOő邾MB
 //
 // WinSock send() ̓obt@TCY(len)Ȃl𐳏펞ɕԂĂ
 // Ƃ̂ŁȀꍇ̓G[ƂȂB
-// ɂATCPRlNVؒf̌댟ohB
-// (2006.12.9 yutaka)
-static int retry_send_packet(PTInstVar pvar, char *data, int len)
+// ܂Asend()̕Ԓl0ŁAG[ԍ 10000 ̏ꍇ́A
+// WSAEWOULDBLOCK ƓlɑMłȂƌȂB(PuTTY 0.58̎Ql)
+//
+// return: MoCgAG[ -1
+static int send_nonblocking(PTInstVar pvar, const char *data, int len, int *err)
 {
-	int n;
-	int err;
+	int sent = 0;
 
+	*err = 0;
 	while (len > 0) {
-		n = (pvar->Psend)(pvar->socket, data, len, 0);
+		int n = (pvar->Psend)(pvar->socket, data, len, 0);
 
 		if (n < 0) {
-			err = WSAGetLastError();
-			if (err < WSABASEERR || err == WSAEWOULDBLOCK) {
-				// send()̕Ԓl0ŁAG[ԍ 10000 ̏ꍇ́A
-				// ̂ƌȂB
-				// PuTTY 0.58̎QlB
-				// (2007.2.4 yutak)
-				return 0; // success
+			int code = WSAGetLastError();
+			if (code < WSABASEERR || code == WSAEWOULDBLOCK) {
+				break;
 			}
-			return 1; // error
+			*err = code;
+			return -1;
 		}
 
 		len -= n;
 		data += n;
+		sent += n;
 	}
 
-	return 0; // success
+	return sent;
 }
 
-static BOOL send_packet_blocking(PTInstVar pvar, char *data, int len)
+// ML[l܂Ď~߂Ă SFTP ̓]ĊJB
+static void ssh2_resume_sftp_transfers(PTInstVar pvar)
 {
-	// pPbgMɃobt@g܂킷߁AubLOőMĂ܂KvB
-	// mubLOőMWSAEWOULDBLOCKԂĂꍇÃobt@͑M
-	// ܂ŕێĂȂĂ͂ȂȂB(2007.10.30 yutaka)
-	u_long do_block = 0;
-	int code = 0;
-	char *kind = NULL, buf[256];
+	int i;
 
-	if ((pvar->PWSAAsyncSelect) (pvar->socket, pvar->NotificationWindow, 0, 0) == SOCKET_ERROR) {
-		code = WSAGetLastError();
-		kind = "WSAAsyncSelect1";
-		goto error;
+	for (i = 0; i < CHANNEL_MAX; i++) {
+		if (channels[i].used && channels[i].type == TYPE_SFTP) {
+			sftp_resume_transfer(pvar, &channels[i]);
+		}
 	}
-	if (ioctlsocket(pvar->socket, FIONBIO, &do_block) == SOCKET_ERROR) {
-		code = WSAGetLastError();
-		kind = "ioctlsocket";
-		goto error;
+}
+
+// ML[̖Ƀf[^ǉB
+// ɋ󂫂Ȃ΁AMς݂̗̈悪𒴂ĂƂMf[^
+// 擪ɋl߂(ǉ̂тɋlߒƃL[ƂɏdȂ邽)B
+// łȂΔ{XŊgB
+static BOOL sendq_append(PTInstVar pvar, const char *data, size_t len)
+{
+	SSHState *st = &pvar->ssh_state;
+	size_t used = st->sendq_tail - st->sendq_head;
+
+	if (st->sendq_tail + len > st->sendq_size &&
+	    st->sendq_head > 0 && st->sendq_head >= st->sendq_size / 2) {
+		memmove(st->sendq, st->sendq + st->sendq_head, used);
+		st->sendq_head = 0;
+		st->sendq_tail = used;
 	}
-	if (retry_send_packet(pvar, data, len) != 0) {
-		code = WSAGetLastError();
-		kind = "retry_send_packet";
-		goto error;
+
+	if (st->sendq_tail + len > st->sendq_size) {
+		size_t newsize = st->sendq_size == 0 ? 64 * 1024 : st->sendq_size;
+		char *p;
+
+		while (newsize < st->sendq_tail + len) {
+			newsize *= 2;
+		}
+		p = realloc(st->sendq, newsize);
+		if (p == NULL) {
+			return FALSE;
+		}
+		st->sendq = p;
+		st->sendq_size = newsize;
 	}
-	if ((pvar->PWSAAsyncSelect) (pvar->socket, pvar->NotificationWindow,
-	                             pvar->notification_msg,
-	                             pvar->notification_events) == SOCKET_ERROR) {
-		code = WSAGetLastError();
-		kind = "WSAAsyncSelect2";
-		goto error;
+
+	memcpy(st->sendq + st->sendq_tail, data, len);
+	st->sendq_tail += len;
+
+	if (!st->sendq_suspended && st->sendq_tail - st->sendq_head >= SSH_SENDQ_HIGH_WATER_MARK) {
+		// 𒴂̂őM(|[g]Ȃ)̓ǂݏo~
+		st->sendq_suspended = TRUE;
+		logprintf(LOG_LEVEL_NOTICE, "%s: send queue is full (%lu bytes).",
+		          __FUNCTION__, (unsigned long)(st->sendq_tail - st->sendq_head));
 	}
+
 	return TRUE;
+}
 
-error:
-	UTIL_get_lang_msg("MSG_SSH_SEND_PKT_ERROR", pvar,
-	                  "A communications error occurred while sending an SSH packet.\n"
-	                  "The connection will close. (%s:%d)");
-	_snprintf_s(buf, sizeof(buf), _TRUNCATE, pvar->UIMsg,
-	            kind, code);
-	notify_fatal_error(pvar, buf, TRUE);
-	return FALSE;
+// ML[ɗ܂Ăf[^𑗐MB
+// FD_WRITE ̒ʒm󂯂ƂƁApPbgMOɌĂ΂B
+void SSH_flush_send_queue(PTInstVar pvar)
+{
+	SSHState *st = &pvar->ssh_state;
+	int n, err;
+
+	if (st->sendq_tail == st->sendq_head) {
+		return;
+	}
+
+	if (pvar->socket == INVALID_SOCKET) {
+		st->sendq_head = st->sendq_tail = 0;
+		return;
+	}
+
+	n = send_nonblocking(pvar, st->sendq + st->sendq_head,
+	                     (int)(st->sendq_tail - st->sendq_head), &err);
+	if (n < 0) {
+		st->sendq_head = st->sendq_tail = 0;
+		send_packet_error(pvar, "send", err);
+		return;
+	}
+	st->sendq_head += n;
+	if (st->sendq_head == st->sendq_tail) {
+		st->sendq_head = st->sendq_tail = 0;
+	}
+
+	if (st->sendq_suspended && st->sendq_tail - st->sendq_head <= SSH_SENDQ_LOW_WATER_MARK) {
+		// ̂őM̓ǂݏoĊJ
+		st->sendq_suspended = FALSE;
+		logprintf(LOG_LEVEL_NOTICE, "%s: send queue was drained (%lu bytes).",
+		          __FUNCTION__, (unsigned long)(st->sendq_tail - st->sendq_head));
+		FWD_resume_local_connections(pvar);
+		ssh2_resume_sftp_transfers(pvar);
+	}
+}
+
+// ML[l܂Ă邩Aɕۑf[^ɒBĂ TRUE ԂB
+BOOL SSH_send_queue_is_full(PTInstVar pvar)
+{
+	return pvar->ssh_state.sendq_suspended || pvar->ssh_state.rekey_suspended;
+}
+
+// ML[ɂȂ܂ŁAő timeout ~b҂B
+// ؒf SSH_MSG_DISCONNECT 𑗂͂邽߂ɎgB
+static void flush_send_queue_wait(PTInstVar pvar, int timeout)
+{
+	SSHState *st = &pvar->ssh_state;
+	DWORD start = GetTickCount();
+
+	while (st->sendq_tail != st->sendq_head && pvar->socket != INVALID_SOCKET) {
+		fd_set wfds;
+		struct timeval tv;
+		DWORD elapsed = GetTickCount() - start;
+
+		if (elapsed >= (DWORD)timeout) {
+			break;
+		}
+		FD_ZERO(&wfds);
+		FD_SET(pvar->socket, &wfds);
+		tv.tv_sec = (timeout - elapsed) / 1000;
+		tv.tv_usec = ((timeout - elapsed) % 1000) * 1000;
+		if (select(0, NULL, &wfds, NULL, &tv) <= 0) {
+			break;
+		}
+		SSH_flush_send_queue(pvar);
+	}
+}
+
+// pPbg𑗐MB
+// ȑO̓\PbgꎞIɃubLO[hɂđ؂ĂA
+// Ml܂ Tera Term Ŝł܂Ă܂߁A؂Ȃ
+// f[^͑ML[ɐς݁AFD_WRITE ̒ʒmő𑗂悤ɂB
+static BOOL send_packet_nonblocking(PTInstVar pvar, char *data, int len)
+{
+	SSHState *st = &pvar->ssh_state;
+	int n, err;
+
+	// ɐς܂Ăf[^΁A邽߂ɑB
+	SSH_flush_send_queue(pvar);
+
+	if (st->sendq_tail == st->sendq_head) {
+		n = send_nonblocking(pvar, data, len, &err);
+		if (n < 0) {
+			send_packet_error(pvar, "send", err);
+			return FALSE;
+		}
+		data += n;
+		len -= n;
+	}
+
+	if (len > 0) {
+		if (!sendq_append(pvar, data, len)) {
+			send_packet_error(pvar, "sendq_append", ERROR_NOT_ENOUGH_MEMORY);
+			return FALSE;
+		}
+	}
+	return TRUE;
 }
 
 /* if skip_compress is true, then the data has already been compressed
@@ -1270,12 +1438,17 @@ void finish_send_packet_special(PTInstVar pvar, int skip_compress)
 		     pvar->ctos_compression == COMP_DELAYED && pvar->userauth_success) &&
 		    pvar->ssh2_keys[MODE_OUT].comp.enabled) {
 			// ̃obt@ packet-length(4) + padding(1) + payload(any) B
-			msg = buffer_init();
-			if (msg == NULL) {
-				// TODO: error check
-				logprintf(LOG_LEVEL_ERROR, "%s: buffer_init returns NULL.", __FUNCTION__);
-				return;
+			// xmۂobt@͎g񂷁B
+			if (pvar->comp_buffer == NULL) {
+				pvar->comp_buffer = buffer_init();
+				if (pvar->comp_buffer == NULL) {
+					// TODO: error check
+					logprintf(LOG_LEVEL_ERROR, "%s: buffer_init returns NULL.", __FUNCTION__);
+					return;
+				}
 			}
+			msg = pvar->comp_buffer;
+			buffer_clear(msg);
 
 			// kΏۂ̓wb_yC[ĥ݁B
 			buffer_append(msg, "\0\0\0\0\0", 5);  // 5 = packet-length(4) + padding(1)
@@ -1358,6 +1531,9 @@ void finish_send_packet_special(PTInstVar pvar, int skip_compress)
 
 		data_length = encryption_size + aadlen + maclen;
 
+		// ̍Č̔Ɏg
+		pvar->ssh2_rekey_bytes[MODE_OUT] += data_length;
+
 		logprintf(150,
 		          "%s: built packet info: "
 		          "aadlen:%d, enclen:%d, padlen:%d, datalen:%d, maclen:%d, "
@@ -1367,9 +1543,7 @@ void finish_send_packet_special(PTInstVar pvar, int skip_compress)
 		          authlen ? "AEAD" : "not AEAD", aadlen ? "EtM" : "E&M");
 	}
 
-	send_packet_blocking(pvar, data, data_length);
-
-	buffer_free(msg);
+	send_packet_nonblocking(pvar, data, data_length);
 
 	pvar->ssh_state.sender_sequence_number++;
 
@@ -2383,6 +2557,9 @@ void SSH2_handle_packet(PTInstVar pvar, char *data, unsigned int len, unsigned i
 {
 	unsigned char message = prep_packet_ssh2(pvar, data, len, aadlen, authlen);
 
+	// ̍Č̔Ɏg
+	pvar->ssh2_rekey_bytes[MODE_IN] += 4 + len + authlen;
+
 	// SSH̃bZ[W^Cv`FbN
 	if (message != SSH_MSG_NONE) {
 		// bZ[W^CvɉnhN
@@ -2412,6 +2589,9 @@ void SSH2_handle_packet(PTInstVar pvar, char *data, unsigned int len, unsigned i
 			}
 		}
 	}
+
+	// pPbg̏IƂŁA̍ČKvׂ
+	ssh2_check_rekey(pvar);
 }
 
 static BOOL handle_pty_success(PTInstVar pvar)
@@ -2515,7 +2695,12 @@ static void enable_send_compression(PTInstVar pvar)
 	pvar->ssh_state.compress_stream.zalloc = NULL;
 	pvar->ssh_state.compress_stream.zfree = NULL;
 	pvar->ssh_state.compress_stream.opaque = NULL;
-	if (deflateInit(&pvar->ssh_state.compress_stream, pvar->ssh_state.compression_level) != Z_OK) {
+	if (SSHv2(pvar)) {
+		// SSH2 ł SSH_CMSG_REQUEST_COMPRESSION ̂ŁAݒ̈kxg
+		pvar->ssh_state.compression_level = pvar->session_settings.CompressionLevel;
+	}
+	if (deflateInit2(&pvar->ssh_state.compress_stream, pvar->ssh_state.compression_level,
+	                 Z_DEFLATED, MAX_WBITS, 8, pvar->session_settings.CompressionStrategy) != Z_OK) {
 		UTIL_get_lang_msg("MSG_SSH_SETUP_COMP_ERROR", pvar,
 		                  "An error occurred while setting up compression.\n"
 		                  "The connection will close.");
@@ -2978,6 +3163,11 @@ void SSH_init(PTInstVar pvar)
 	pvar->ssh_state.server_ID = NULL;
 	pvar->ssh_state.receiver_sequence_number = 0;
 	pvar->ssh_state.sender_sequence_number = 0;
+	pvar->ssh_state.sendq = NULL;
+	pvar->ssh_state.sendq_size = 0;
+	pvar->ssh_state.sendq_head = 0;
+	pvar->ssh_state.sendq_tail = 0;
+	pvar->ssh_state.sendq_suspended = FALSE;
 	for (i = 0; i < NUM_ELEM(pvar->ssh_state.packet_handlers); i++) {
 		pvar->ssh_state.packet_handlers[i] = NULL;
 	}
@@ -2993,6 +3183,7 @@ void SSH_init(PTInstVar pvar)
 	pvar->ask4passwd = 0; // disabled(default) (2006.9.18 maya)
 	pvar->userauth_retry_count = 0;
 	pvar->decomp_buffer = NULL;
+	pvar->comp_buffer = NULL;
 	pvar->authbanner_buffer = NULL;
 	pvar->ssh2_authlist = NULL; // (2007.4.27 yutaka)
 	pvar->tryed_ssh2_authlist = FALSE;
@@ -3001,6 +3192,14 @@ void SSH_init(PTInstVar pvar)
 	pvar->nosession = FALSE;
 	pvar->server_sig_algs = NULL;
 	pvar->server_strict_kex = FALSE;
+	pvar->ssh2_rtt = 0;
+	pvar->ssh2_rekey_bytes[MODE_IN] = 0;
+	pvar->ssh2_rekey_bytes[MODE_OUT] = 0;
+	pvar->ssh2_rekey_time = 0;
+	pvar->ssh2_rekey_start_tick = 0;
+	pvar->ssh2_rekey_count = 0;
+	pvar->ssh2_rekey_stall_last = 0;
+	pvar->ssh2_rekey_stall_max = 0;
 
 }
 
@@ -3051,12 +3250,20 @@ void SSH_notify_disconnecting(PTInstVar pvar, char *reason)
 
 		logputs(LOG_LEVEL_VERBOSE, "SSH2_MSG_DISCONNECT was sent at SSH_notify_disconnecting().");
 	}
+
+	// Ƀ\Pbg̂ŁAL[ɎcĂΏ҂đo
+	flush_send_queue_wait(pvar, 1000);
 }
 
 void ssh2_finish_encryption_setup(PTInstVar pvar)
 {
 	notify_established_secure_connection(pvar);
 	pvar->ssh_state.status_flags &= ~STATUS_DONT_SEND_USER_NAME;
+
+	// ̍Č̔͂琔
+	pvar->ssh2_rekey_bytes[MODE_IN] = 0;
+	pvar->ssh2_rekey_bytes[MODE_OUT] = 0;
+	pvar->ssh2_rekey_time = time(NULL);
 }
 
 void SSH_notify_host_OK(PTInstVar pvar)
@@ -3474,6 +3681,16 @@ void SSH_get_mac_info(PTInstVar pvar, char *dest, int len)
 	            get_ssh2_mac_name(pvar->macs[MODE_IN]));
 }
 
+void SSH_get_rekey_info(PTInstVar pvar, char *dest, int len)
+{
+	UTIL_get_lang_msgU8("DLG_ABOUT_REKEY_INFO", pvar,
+						"%d times; last stall %lu ms, max %lu ms");
+	_snprintf_s(dest, len, _TRUNCATE, pvar->UIMsg,
+	            pvar->ssh2_rekey_count,
+	            pvar->ssh2_rekey_stall_last,
+	            pvar->ssh2_rekey_stall_max);
+}
+
 void SSH_end(PTInstVar pvar)
 {
 	int i;
@@ -3505,6 +3722,12 @@ void SSH_end(PTInstVar pvar)
 	            &pvar->ssh_state.precompress_outbuflen);
 	buf_destroy(&pvar->ssh_state.postdecompress_inbuf,
 	            &pvar->ssh_state.postdecompress_inbuflen);
+	free(pvar->ssh_state.sendq);
+	pvar->ssh_state.sendq = NULL;
+	pvar->ssh_state.sendq_size = 0;
+	pvar->ssh_state.sendq_head = 0;
+	pvar->ssh_state.sendq_tail = 0;
+	pvar->ssh_state.sendq_suspended = FALSE;
 	pvar->agentfwd_enable = FALSE;
 	pvar->use_subsystem = FALSE;
 	pvar->nosession = FALSE;
@@ -3566,6 +3789,20 @@ void SSH_end(PTInstVar pvar)
 			pvar->decomp_buffer = NULL;
 		}
 
+		if (pvar->comp_buffer != NULL) {
+			buffer_free(pvar->comp_buffer);
+			pvar->comp_buffer = NULL;
+		}
+
+		{
+			buffer_stat_t stat;
+
+			buffer_get_stat(&stat);
+			logprintf(LOG_LEVEL_VERBOSE, "%s: buffer allocation: malloc=%lu free=%lu reuse=%lu grow=%lu", __FUNCTION__,
+			          stat.mallocs, stat.frees, stat.reuses, stat.grows);
+			buffer_pool_clear();
+		}
+
 		if (pvar->authbanner_buffer != NULL) {
 			buffer_free(pvar->authbanner_buffer);
 			pvar->authbanner_buffer = NULL;
@@ -3595,6 +3832,7 @@ void SSH_end(PTInstVar pvar)
 				free(pvar->ssh2_keys[mode].mac.key);
 				pvar->ssh2_keys[mode].mac.key = NULL;
 			}
+			CRYPT_free_MAC_ctx(&pvar->ssh2_keys[mode].mac);
 		}
 	}
 }
@@ -3826,14 +4064,12 @@ void SSH2_channel_input_eof(PTInstVar pvar, Channel_t *c)
 	if (c == NULL)
 		return;
 
-	// SSH2̏ꍇApPbĝĂB(2005.6.21 yutaka)
+	// SSH2̏ꍇ͑Ȃ̂ŁÅɑB
+	// ɕۑf[^ EOF ͂Ȃ悤A
+	// ssh2_channel_retry_send_bufchain() ŕۑ𑗂IĂ瑗B
 	if (pvar->kex_status & KEX_FLAG_REKEYING) {
-		// TODO: zƂĂ̓pPbgjł͂ȂApPbgǂݎxɂƂ낾A
-		// ƂɂB
-		logprintf(LOG_LEVEL_INFO, "%s: now rekeying. data is not sent.", __FUNCTION__);
-
-		c = NULL;
-
+		logprintf(LOG_LEVEL_INFO, "%s: now rekeying. EOF is deferred.", __FUNCTION__);
+		c->state |= SSH_CHANNEL_STATE_EOF_PENDING;
 		return;
 	}
 
@@ -4422,22 +4658,14 @@ int SSH_start_scp_receive(PTInstVar pvar, char *filename)
 }
 
 
-int SSH_sftp_transaction(PTInstVar pvar)
+// SFTPp̃`lJBTuVXe̗vƃlSVG[V̓`lJĂsB
+static Channel_t *ssh2_sftp_open_channel(PTInstVar pvar)
 {
 	buffer_t *msg;
 	char *s;
 	unsigned char *outmsg;
 	int len;
 	Channel_t *c = NULL;
-//	FILE *fp = NULL;
-//	struct __stat64 st;
-
-	// \PbgN[YĂꍇ͉ȂB
-	if (pvar->socket == INVALID_SOCKET)
-		goto error;
-
-	if (SSHv1(pvar))      // SSH1T|[gTBD
-		goto error;
 
 	// `lݒ
 	c = ssh2_channel_new(CHAN_SES_WINDOW_DEFAULT, CHAN_SES_PACKET_DEFAULT, TYPE_SFTP, -1);
@@ -4466,13 +4694,143 @@ int SSH_sftp_transaction(PTInstVar pvar)
 
 	logputs(LOG_LEVEL_VERBOSE, "SSH2_MSG_CHANNEL_OPEN was sent at SSH_sftp_transaction().");
 
-	return TRUE;
+	return c;
 
 error:
 	if (c != NULL)
 		ssh2_channel_delete(c);
 
-	return FALSE;
+	return NULL;
+}
+
+int SSH_sftp_transaction(PTInstVar pvar)
+{
+	// \PbgN[YĂꍇ͉ȂB
+	if (pvar->socket == INVALID_SOCKET)
+		return FALSE;
+
+	if (SSHv1(pvar))      // SSH1T|[gTBD
+		return FALSE;
+
+	return ssh2_sftp_open_channel(pvar) != NULL;
+}
+
+// SFTPŃt@C]B
+// SFTP`lJĂ΂gAȂΐVJāAlSVG[Vςł]B
+// localfile/remotefile ̕Е̏ꍇ́Ãt@CgB
+// resume  0 ȊÔƂ́A]ɂr܂ł̃t@C̑]B
+int SSH_sftp_transfer(PTInstVar pvar, enum sftp_xfer_dir dir, const char *localfile, const char *remotefile, int resume)
+{
+	Channel_t *c = NULL;
+	FILE *fp = NULL;
+	struct __stat64 st;
+	char local[MAX_PATH], remote[1024];
+	unsigned long long localsize = 0;
+	const char *fn;
+	int i;
+
+	// \PbgN[YĂꍇ͉ȂB
+	if (pvar->socket == INVALID_SOCKET)
+		return FALSE;
+
+	if (SSHv1(pvar))      // SSH1T|[gTBD
+		return FALSE;
+
+	for (i = 0; i < CHANNEL_MAX; i++) {
+		if (channels[i].used && channels[i].type == TYPE_SFTP) {
+			c = &channels[i];
+			break;
+		}
+	}
+	if (c != NULL && c->sftp.xfer.dir != SFTP_XFER_NONE) {
+		logprintf(LOG_LEVEL_NOTICE, "%s: SFTP transfer is already in progress.", __FUNCTION__);
+		return FALSE;
+	}
+
+	if (dir == SFTP_XFER_GET) {
+		if (remotefile == NULL || remotefile[0] == '\0')
+			return FALSE;
+		strncpy_s(remote, sizeof(remote), remotefile, _TRUNCATE);
+
+		if (localfile == NULL || localfile[0] == '\0') {
+			wchar_t *FileDirExpanded;
+			char *FileDirExpandedU8;
+
+			fn = strrchr(remotefile, '/');
+			if (fn && fn[1] == '\0')
+				return FALSE;
+
+			FileDirExpanded = GetFileDir(pvar->ts);
+			FileDirExpandedU8 = ToU8W(FileDirExpanded);
+			_snprintf_s(local, sizeof(local), _TRUNCATE, "%s\\%s", FileDirExpandedU8, fn ? fn + 1 : remotefile);
+			free(FileDirExpanded);
+			free(FileDirExpandedU8);
+		} else {
+			strncpy_s(local, sizeof(local), localfile, _TRUNCATE);
+		}
+
+		if (resume && statU8(local, &st) == 0) {
+			fp = fopenU8(local, "r+b");
+			localsize = st.st_size;
+		} else {
+			fp = fopenU8(local, "wb");
+		}
+	} else {
+		if (localfile == NULL || localfile[0] == '\0')
+			return FALSE;
+		strncpy_s(local, sizeof(local), localfile, _TRUNCATE);
+
+		if (remotefile == NULL || remotefile[0] == '\0') {
+			ExtractFileNameU8(localfile, remote, sizeof(remote));
+		} else {
+			strncpy_s(remote, sizeof(remote), remotefile, _TRUNCATE);
+		}
+
+		if (statU8(local, &st) == 0) {
+			localsize = st.st_size;
+			fp = fopenU8(local, "rb");
+		}
+	}
+
+	if (fp == NULL) {
+		static const TTMessageBoxInfoW info_read = {
+			"TTSSH",
+			"MSG_SSH_SCP_FILEOPEN_ERROR_TITLE", L"TTSSH: file open error",
+			"MSG_SSH_SCP_FILEOPEN_READ_ERROR", L"Can't open file for reading: %s %s",
+			MB_OK | MB_ICONERROR
+		};
+		static const TTMessageBoxInfoW info_write = {
+			"TTSSH",
+			"MSG_SSH_SCP_FILEOPEN_ERROR_TITLE", L"TTSSH: file open error",
+			"MSG_SSH_SCP_FILEOPEN_WRITE_ERROR", L"Can't open file for writing: %s %s",
+			MB_OK | MB_ICONERROR
+		};
+		DWORD error = GetLastError();
+		wchar_t *err_str;
+		wchar_t *fname;
+		hFormatMessageW(error, &err_str);
+		fname = ToWcharU8(local);
+		TTMessageBoxW(pvar->cv->HWin, dir == SFTP_XFER_GET ? &info_write : &info_read,
+		              pvar->ts->UILanguageFileW, err_str, fname);
+		free(fname);
+		free(err_str);
+		return FALSE;
+	}
+
+	if (c == NULL) {
+		c = ssh2_sftp_open_channel(pvar);
+		if (c == NULL) {
+			fclose(fp);
+			return FALSE;
+		}
+	}
+
+	return sftp_start_transfer(pvar, c, dir, fp, local, remote, resume, localsize);
+}
+
+int SSH_sftp_transfer_status(void)
+{
+	return sftp_get_transfer_status();
 }
 
 
@@ -4816,6 +5174,7 @@ static BOOL handle_SSH2_kexinit(PTInstVar pvar)
 	// Ăꍇ́AL[č쐬sB(2004.10.24 yutaka)
 	if (pvar->kex_status == KEX_FLAG_KEXDONE) {
 		pvar->kex_status = KEX_FLAG_REKEYING;
+		pvar->ssh2_rekey_start_tick = GetTickCount();
 
 		// L[č쐬 myproposal  ",ext-info-c,kex-strict-c-v00@openssh.com" 폜
 		// XV̂ KEX ݂̂ł悢
@@ -5571,8 +5930,10 @@ static void ssh2_set_newkeys(PTInstVar pvar, int mode)
 	if (pvar->ssh2_keys[mode].mac.key != NULL) {
 		free(pvar->ssh2_keys[mode].mac.key);
 	}
+	CRYPT_free_MAC_ctx(&pvar->ssh2_keys[mode].mac);
 
 	pvar->ssh2_keys[mode] = current_keys[mode];
+	pvar->ssh2_keys[mode].mac.ctx = NULL;
 }
 
 static BOOL ssh2_kex_finish(PTInstVar pvar, char *hash, int hashlen, BIGNUM *share_key, Key *hostkey, char *signature, int siglen)
@@ -5665,7 +6026,7 @@ static void ssh2_send_newkeys(PTInstVar pvar)
 	// SSH2_MSG_NEWKEYS Ɏ󂯎ĂKEX͊B̏ɈڂB
 	if (pvar->kex_status & KEX_FLAG_NEWKEYS_RECEIVED) {
 		if ((pvar->kex_status & KEX_FLAG_REKEYING)) {
-			do_SSH2_dispatch_setup_for_transfer(pvar);
+			ssh2_finish_rekey(pvar);
 		}
 		else {
 			//  SSH2_MSG_NEWKEYS ̑MAȍ~̒ʐM͈ÍꂽԂɂȂ
@@ -6231,6 +6592,107 @@ static void do_SSH2_dispatch_setup_for_transfer(PTInstVar pvar)
 	SSH2_dispatch_add_message(SSH2_MSG_KEXINIT);
 }
 
+// ̍Čn߂鑗Mʂ̏(oCg)
+// RekeyLimit  0 ̏ꍇ OpenSSH ƓlɈÍ̃ubN猈߂B
+// 16oCgȏ̃ubNÍł 2^32 ubNAȊOł 2^30 oCgB
+static unsigned long long ssh2_rekey_limit(PTInstVar pvar, int mode)
+{
+	unsigned int block_size;
+
+	if (pvar->settings.RekeyLimit > 0) {
+		return (unsigned long long)pvar->settings.RekeyLimit * 1024 * 1024;
+	}
+
+	if (mode == MODE_OUT) {
+		block_size = CRYPT_get_encryption_block_size(pvar);
+	}
+	else {
+		block_size = CRYPT_get_decryption_block_size(pvar);
+	}
+	if (block_size >= 16) {
+		return ((unsigned long long)1 << 32) * block_size;
+	}
+	return (unsigned long long)1 << 30;
+}
+
+// Ǒ̑Mʂ͌oߎԂ𒴂ĂA
+// NCAg献̍Čn߂B
+// ̃`lf[^ SSH2_send_channel_data() Ńobt@ɕۑA
+//  ssh2_finish_rekey() őB
+static void ssh2_check_rekey(PTInstVar pvar)
+{
+	const char *reason = NULL;
+
+	if (!SSHv2(pvar) || pvar->kex_status != KEX_FLAG_KEXDONE || !pvar->userauth_success) {
+		return;
+	}
+
+	if (pvar->ssh2_rekey_bytes[MODE_OUT] >= ssh2_rekey_limit(pvar, MODE_OUT) ||
+	    pvar->ssh2_rekey_bytes[MODE_IN] >= ssh2_rekey_limit(pvar, MODE_IN)) {
+		reason = "data limit";
+	}
+	else if (pvar->settings.RekeyInterval > 0 &&
+	         time(NULL) - pvar->ssh2_rekey_time >= pvar->settings.RekeyInterval) {
+		reason = "time limit";
+	}
+	if (reason == NULL) {
+		return;
+	}
+
+	logprintf(LOG_LEVEL_INFO, "%s: %s reached, start rekeying. (in:%uKB, out:%uKB)", __FUNCTION__, reason,
+	          (unsigned int)(pvar->ssh2_rekey_bytes[MODE_IN] / 1024),
+	          (unsigned int)(pvar->ssh2_rekey_bytes[MODE_OUT] / 1024));
+
+	pvar->kex_status = KEX_FLAG_REKEYING;
+	pvar->ssh2_rekey_start_tick = GetTickCount();
+
+	// L[č쐬 myproposal  ",ext-info-c,kex-strict-c-v00@openssh.com" 폜
+	SSH2_update_kex_myproposal(pvar);
+
+	// T[o SSH2_MSG_KEXINIT  handle_SSH2_kexinit() Ŏ󂯎
+	SSH2_send_kexinit(pvar);
+}
+
+// ̍Č̊
+static void ssh2_finish_rekey(PTInstVar pvar)
+{
+	int i;
+	Channel_t *c;
+	DWORD stall = GetTickCount() - pvar->ssh2_rekey_start_tick;
+
+	do_SSH2_dispatch_setup_for_transfer(pvar);
+
+	pvar->ssh2_rekey_count++;
+	pvar->ssh2_rekey_stall_last = stall;
+	if (stall > pvar->ssh2_rekey_stall_max) {
+		pvar->ssh2_rekey_stall_max = stall;
+	}
+	pvar->ssh2_rekey_bytes[MODE_IN] = 0;
+	pvar->ssh2_rekey_bytes[MODE_OUT] = 0;
+	pvar->ssh2_rekey_time = time(NULL);
+
+	logprintf(LOG_LEVEL_INFO, "%s: rekey #%d done, transfer was stalled for %lu ms.", __FUNCTION__,
+	          pvar->ssh2_rekey_count, stall);
+
+	// 炸obt@ɕۑĂf[^𑗂A~߂Ă WINDOW_ADJUST 𑗂
+	for (i = 0 ; i < CHANNEL_MAX ; i++) {
+		c = &channels[i];
+		if (c->used) {
+			ssh2_channel_retry_send_bufchain(pvar, c);
+			do_SSH2_adjust_window_size(pvar, c);
+		}
+	}
+
+	// Ɏ~߂ĂMĊJ
+	if (pvar->ssh_state.rekey_suspended) {
+		pvar->ssh_state.rekey_suspended = FALSE;
+		if (!pvar->ssh_state.sendq_suspended) {
+			FWD_resume_local_connections(pvar);
+			ssh2_resume_sftp_transfers(pvar);
+		}
+	}
+}
+
 
 static BOOL handle_SSH2_newkeys(PTInstVar pvar)
 {
@@ -6266,18 +6728,7 @@ static BOOL handle_SSH2_newkeys(PTInstVar pvar)
 	// SSH2_MSG_NEWKEYS ɑĂKEX͊B̏ɈڂB
 	if (pvar->kex_status & KEX_FLAG_NEWKEYS_SENT) {
 		if (pvar->kex_status & KEX_FLAG_REKEYING) {
-			int i;
-			Channel_t *c;
-
-			do_SSH2_dispatch_setup_for_transfer(pvar);
-
-			// 炸obt@ɕۑĂf[^𑗂
-			for (i = 0 ; i < CHANNEL_MAX ; i++) {
-				c = &channels[i];
-				if (c->used) {
-					ssh2_channel_retry_send_bufchain(pvar, c);
-				}
-			}
+			ssh2_finish_rekey(pvar);
 		}
 		else {
 			//  SSH2_MSG_NEWKEYS ̑MAȍ~̒ʐM͈ÍꂽԂɂȂ
@@ -6448,7 +6899,7 @@ BOOL do_SSH2_authrequest(PTInstVar pvar)
 	int len;
 	char *connect_id = "ssh-connection";
 
-	msg = buffer_init();
+	msg = buffer_init_secret();
 	if (msg == NULL) {
 		// TODO: error check
 		logprintf(LOG_LEVEL_ERROR, "%s: buffer_init returns NULL.", __FUNCTION__);
@@ -6508,7 +6959,7 @@ BOOL do_SSH2_authrequest(PTInstVar pvar)
 		keyalgo_name = get_ssh2_hostkey_algorithm_name(keyalgo);
 
 		// step1
-		signbuf = buffer_init();
+		signbuf = buffer_init_secret();
 		if (signbuf == NULL) {
 			buffer_free(blob);
 			goto error;
@@ -6639,7 +7090,11 @@ error:
 //
 // [hX_CAOpPbgM悤ɕύXB(2007.12.26 yutaka)
 //
+// M̂Ȃ(M̂݁A܂͖ʐM)ڑł RekeyInterval ɂ
+// ̍Čn܂悤ɁA̍Č̗vۂIɊmFB
+//
 #define WM_SEND_HEARTBEAT (WM_USER + 1)
+#define WM_CHECK_REKEY (WM_USER + 2)
 
 static LRESULT CALLBACK ssh_heartbeat_dlg_proc(HWND hWnd, UINT msg, WPARAM wp, LPARAM lp)
 {
@@ -6682,6 +7137,10 @@ static LRESULT CALLBACK ssh_heartbeat_dlg_proc(HWND hWnd, UINT msg, WPARAM wp, L
 			return TRUE;
 			break;
 
+		case WM_CHECK_REKEY:
+			ssh2_check_rekey((PTInstVar)wp);
+			return TRUE;
+
 		case WM_COMMAND:
 			switch (wp) {
 			}
@@ -6719,6 +7178,7 @@ static unsigned __stdcall ssh_heartbeat_thread(void *p)
 	static int instance = 0;
 	PTInstVar pvar = (PTInstVar)p;
 	time_t tick;
+	time_t rekey_checked = time(NULL);
 
 	// łɎsȂ牽ɕԂB
 	if (instance > 0)
@@ -6739,6 +7199,13 @@ static unsigned __stdcall ssh_heartbeat_thread(void *p)
 			SendMessage(pvar->ssh_hearbeat_dialog, WM_SEND_HEARTBEAT, (WPARAM)pvar, 0);
 		}
 
+		// ̍Č̗vۂ1bƂɊmFB
+		// pPbgM𔺂̂ŃCXbhōsB
+		if (SSHv2(pvar) && time(NULL) != rekey_checked) {
+			rekey_checked = time(NULL);
+			SendMessage(pvar->ssh_hearbeat_dialog, WM_CHECK_REKEY, (WPARAM)pvar, 0);
+		}
+
 		Sleep(100); // yield
 	}
 
@@ -7275,7 +7742,7 @@ BOOL handle_SSH2_userauth_inforeq(PTInstVar pvar)
 
 	///////// step2
 	// T[oփpXt[Y𑗂
-	msg = buffer_init();
+	msg = buffer_init_secret();
 	if (msg == NULL) {
 		// TODO: error check
 		logprintf(LOG_LEVEL_ERROR, "%s: buffer_init returns NULL.", __FUNCTION__);
@@ -7377,7 +7844,7 @@ BOOL handle_SSH2_userauth_pkok(PTInstVar pvar)
 		username = pvar->auth_state.user;  // [U
 
 		// f[^쐬
-		signbuf = buffer_init();
+		signbuf = buffer_init_secret();
 		if (signbuf == NULL) {
 			safefree(pvar->pageant_key);
 			return FALSE;
@@ -7424,7 +7891,7 @@ BOOL handle_SSH2_userauth_pkok(PTInstVar pvar)
 
 
 		// yC[h̍\z
-		msg = buffer_init();
+		msg = buffer_init_secret();
 		if (msg == NULL) {
 			safefree(pvar->pageant_key);
 			safefree(signedmsg);
@@ -7607,7 +8074,7 @@ BOOL handle_SSH2_userauth_passwd_changereq(PTInstVar pvar)
 	free(info);
 	free(lang);
 
-	msg = buffer_init();
+	msg = buffer_init_secret();
 	if (msg == NULL) {
 		logprintf(LOG_LEVEL_ERROR, "%s: buffer_init returns NULL.", __FUNCTION__);
 		return FALSE;
@@ -7828,6 +8295,21 @@ static BOOL handle_SSH2_open_confirm(PTInstVar pvar)
 	data += 4;
 
 	c->remote_id = remote_id;
+
+	// CHANNEL_OPEN 𑗂Ă̎ԂԂƂ݂ȂAŏloĂB
+	// local window̎ŎgpB
+	{
+		DWORD rtt = GetTickCount() - c->window_tick;
+		if (rtt == 0) {
+			rtt = 1;
+		}
+		if (pvar->ssh2_rtt == 0 || rtt < pvar->ssh2_rtt) {
+			pvar->ssh2_rtt = rtt;
+			logprintf(LOG_LEVEL_VERBOSE, "%s: rtt=%lums", __FUNCTION__, rtt);
+		}
+	}
+	c->window_tick = GetTickCount();
+
 	if (c->self_id == pvar->shell_id) {
 		// ŏ̃`lȊOŃZbgĂ͂Ȃ (2008.12.19 maya)
 		pvar->session_nego_status = 1;
@@ -8165,6 +8647,36 @@ static BOOL handle_SSH2_channel_failure(PTInstVar pvar)
 
 
 
+// local window̎
+//
+// window̔g؂܂ł̎ԂԂ2{ZƂ́A
+// WINDOW_ADJUST ͂OɃT[oM~߂Ă܂(windowш敝xς菬)
+// ̂ŁAlocal_window_max {ɂB ChannelWindowMaxB
+static void ssh2_autotune_window(PTInstVar pvar, Channel_t *c)
+{
+	DWORD now = GetTickCount();
+	DWORD elapsed = now - c->window_tick;
+	unsigned int ceiling = (unsigned int)pvar->settings.ChannelWindowMax;
+
+	c->window_tick = now;
+
+	if (ceiling == 0 || pvar->ssh2_rtt == 0 || c->local_window_max >= ceiling) {
+		return;
+	}
+	if (elapsed >= 2 * pvar->ssh2_rtt) {
+		return;
+	}
+
+	if (c->local_window_max > ceiling / 2) {
+		c->local_window_max = ceiling;
+	}
+	else {
+		c->local_window_max *= 2;
+	}
+	logprintf(LOG_LEVEL_VERBOSE, "%s: channel=%d local_window_max=%u (elapsed=%lums rtt=%lums)",
+	          __FUNCTION__, c->self_id, c->local_window_max, elapsed, pvar->ssh2_rtt);
+}
+
 // NCAgwindow sizeT[o֒m点
 static void do_SSH2_adjust_window_size(PTInstVar pvar, Channel_t *c)
 {
@@ -8179,6 +8691,12 @@ static void do_SSH2_adjust_window_size(PTInstVar pvar, Channel_t *c)
 	if (c->local_window > c->local_window_max/2)
 		return;
 
+	// ͑Ȃ̂ŁA ssh2_finish_rekey() 瑗
+	if (pvar->kex_status & KEX_FLAG_REKEYING)
+		return;
+
+	ssh2_autotune_window(pvar, c);
+
 	{
 		// pty open
 		msg = buffer_init();
@@ -8239,6 +8757,7 @@ void ssh2_channel_send_close(PTInstVar pvar, Channel_t *c)
 #define WM_SENDING_FILE (WM_USER + 1)
 #define WM_CHANNEL_CLOSE (WM_USER + 2)
 #define WM_GET_CLOSED_STATUS (WM_USER + 3)
+#define WM_SENDING_FILE_ASYNC (WM_USER + 4)
 
 typedef struct scp_dlg_parm {
 	Channel_t *c;
@@ -8247,6 +8766,21 @@ typedef struct scp_dlg_parm {
 	size_t buflen;
 } scp_dlg_parm_t;
 
+// ǂݏoPʂ̓`l̍őpPbg傫̂ŁAđ
+static void ssh_scp_send_data(PTInstVar pvar, Channel_t *c, char *buf, size_t buflen)
+{
+	unsigned int n;
+
+	while (buflen > 0) {
+		n = (unsigned int)buflen;
+		if (c->remote_maxpacket > 0 && n > c->remote_maxpacket)
+			n = c->remote_maxpacket;
+		SSH2_send_channel_data(pvar, c, buf, n, 0);
+		buf += n;
+		buflen -= n;
+	}
+}
+
 static INT_PTR CALLBACK ssh_scp_dlg_proc(HWND hWnd, UINT msg, WPARAM wp, LPARAM lp)
 {
 	static int closed = 0;
@@ -8271,7 +8805,19 @@ static INT_PTR CALLBACK ssh_scp_dlg_proc(HWND hWnd, UINT msg, WPARAM wp, LPARAM
 			{
 			scp_dlg_parm_t *parm = (scp_dlg_parm_t *)wp;
 
-			SSH2_send_channel_data(parm->pvar, parm->c, parm->buf, parm->buflen, 0);
+			ssh_scp_send_data(parm->pvar, parm->c, parm->buf, parm->buflen);
+			}
+			return TRUE;
+			break;
+
+		// MXbhPostMessageꂽf[^𑗂BIobt@ԂB
+		case WM_SENDING_FILE_ASYNC:
+			{
+			Channel_t *c = (Channel_t *)wp;
+			scp_sendbuf_t *sb = (scp_sendbuf_t *)lp;
+
+			ssh_scp_send_data(c->scp.pvar, c, sb->buf, sb->buflen);
+			SetEvent(sb->done);
 			}
 			return TRUE;
 			break;
@@ -8334,6 +8880,19 @@ static int is_canceled_window(HWND hd)
 		return 0;
 }
 
+// Mobt@(CXbhMI)܂ő҂
+static int ssh_scp_wait_sent(PTInstVar pvar, Channel_t *c, scp_sendbuf_t *sb)
+{
+	// socket or channelN[YꂽAbZ[W͏Ȃ̂ő҂Ȃ
+	while (WaitForSingleObject(sb->done, 100) == WAIT_TIMEOUT) {
+		if (pvar->socket == INVALID_SOCKET || c->scp.state == SCP_CLOSING || c->used == 0)
+			return FALSE;
+	}
+	return TRUE;
+}
+
+// t@CǂݏoăT[o֑Xbh
+// obt@2pӂACXbhЕÍđĂԂɁAЕ֎ǂݏoB
 static unsigned __stdcall ssh_scp_thread(void *p)
 {
 	Channel_t *c = (Channel_t *)p;
@@ -8345,12 +8904,20 @@ static unsigned __stdcall ssh_scp_thread(void *p)
 	size_t ret;
 	HWND hWnd = c->scp.progress_window;
 	scp_dlg_parm_t parm;
+	scp_sendbuf_t *sendbuf = c->scp.sendbuf;
+	int cur = 0;
+	int i;
 	int rate, ProgStat;
 	DWORD stime;
 	int elapsed, prev_elapsed;
 
-	buflen = min(c->remote_window, 8192*4); // max 32KB
-	buf = malloc(buflen);
+	buflen = SCPSND_BUFFER_SIZE;
+	for (i = 0; i < SCPSND_BUFFER_NUM; i++) {
+		sendbuf[i].buf = malloc(buflen);
+		sendbuf[i].done = CreateEvent(NULL, FALSE, TRUE, NULL);
+		if (sendbuf[i].buf == NULL || sendbuf[i].done == NULL)
+			goto abort;
+	}
 
 	SetDlgItemTextU8(hWnd, IDC_FILENAME, c->scp.localfilefull);
 
@@ -8366,11 +8933,26 @@ static unsigned __stdcall ssh_scp_thread(void *p)
 		if (is_canceled_window(hWnd))
 			goto cancel_abort;
 
+		// O񂱂̃obt@ɓǂ񂾃f[^̑MÎ҂
+		if (!ssh_scp_wait_sent(pvar, c, &sendbuf[cur]))
+			goto abort;
+		buf = sendbuf[cur].buf;
+
 		// t@Cǂݍ񂾃f[^͂Ȃ炸T[o֑MB
-		readlen = max(4096, min(buflen, c->remote_window)); // min 4KB
+		readlen = (int)max(4096, min(buflen, c->remote_window)); // min 4KB
 		ret = fread(buf, 1, readlen, c->scp.localfp);
-		if (ret == 0)
+		if (ret == 0) {
+			SetEvent(sendbuf[cur].done);
 			break;
+		}
+
+		// ML[󂭂܂ő҂
+		// (CXbhoɂf[^ɐς܂Ȃ悤ɂ)
+		while (SSH_send_queue_is_full(pvar)) {
+			if (pvar->socket == INVALID_SOCKET || c->scp.state == SCP_CLOSING || c->used == 0)
+				goto abort;
+			Sleep(100);
+		}
 
 		// remote_window 񕜂܂ő҂
 		do {
@@ -8391,11 +8973,11 @@ static unsigned __stdcall ssh_scp_thread(void *p)
 		} while (ret > c->remote_window);
 
 		// sending data
-		parm.buf = buf;
-		parm.buflen = ret;
-		parm.c = c;
-		parm.pvar = pvar;
-		SendMessage(hWnd, WM_SENDING_FILE, (WPARAM)&parm, 0);
+		// M̊͑҂ɁÃobt@֎ǂݏo
+		sendbuf[cur].buflen = ret;
+		if (!PostMessage(hWnd, WM_SENDING_FILE_ASYNC, (WPARAM)c, (LPARAM)&sendbuf[cur]))
+			goto abort;
+		cur = (cur + 1) % SCPSND_BUFFER_NUM;
 
 		total_size += ret;
 
@@ -8430,9 +9012,16 @@ static unsigned __stdcall ssh_scp_thread(void *p)
 
 	} while (ret <= buflen);
 
+	// M̃f[^ׂđĂEOF𑗂
+	for (i = 0; i < SCPSND_BUFFER_NUM; i++) {
+		if (!ssh_scp_wait_sent(pvar, c, &sendbuf[i]))
+			goto abort;
+	}
+
 	// eof
 	c->scp.state = SCP_DATA;
 
+	buf = sendbuf[0].buf;
 	buf[0] = '\0';
 	parm.buf = buf;
 	parm.buflen = 1;
@@ -8442,8 +9031,6 @@ static unsigned __stdcall ssh_scp_thread(void *p)
 
 	ShowWindow(hWnd, SW_HIDE);
 
-	free(buf);
-
 	return 0;
 
 cancel_abort:
@@ -8456,8 +9043,6 @@ cancel_abort:
 
 abort:
 
-	free(buf);
-
 	return 0;
 }
 
@@ -8531,7 +9116,7 @@ static unsigned __stdcall ssh_scp_receive_thread(void *p)
 	HWND hWnd = c->scp.progress_window;
 	MSG msg;
 	unsigned char *data;
-	unsigned int buflen;
+	unsigned int buflen, consumed;
 	int eof;
 	int rate, ProgStat;
 	DWORD stime;
@@ -8557,9 +9142,10 @@ static unsigned __stdcall ssh_scp_receive_thread(void *p)
 				//data = (unsigned char *)msg.wParam;
 				//buflen = (unsigned int)msg.lParam;
 				eof = 0;
+				consumed = buflen;
 
 				if (c->scp.filercvsize >= c->scp.filetotalsize) { // EOF
-					free(data);  // free!
+					ssh2_scp_consume_packetlist(pvar, c, consumed);
 					goto done;
 				}
 
@@ -8570,11 +9156,12 @@ static unsigned __stdcall ssh_scp_receive_thread(void *p)
 
 				c->scp.filercvsize += buflen;
 
+				// ܂Ă镪܂Ƃ߂ďo
 				if (fwrite(data, 1, buflen, c->scp.localfp) < buflen) { // error
 					// TODO:
 				}
 
-				free(data);  // free!
+				ssh2_scp_consume_packetlist(pvar, c, consumed);
 
 				rate =(int)(100 * c->scp.filercvsize / c->scp.filetotalsize);
 				_snprintf_s(s, sizeof(s), _TRUNCATE, "%lld / %lld (%d%%)", c->scp.filercvsize, c->scp.filetotalsize, rate);
@@ -8612,7 +9199,10 @@ static unsigned __stdcall ssh_scp_receive_thread(void *p)
 				break;
 			}
 		}
-		Sleep(0);
+		else {
+			// Mf[^͂܂ő҂
+			WaitForSingleObject(c->scp.pktlist_event, 100);
+		}
 	}
 
 done:
@@ -8659,34 +9249,51 @@ static void CALLBACK do_SSH2_adjust_window_size_timer(
 	do_SSH2_adjust_window_size(pvar, c);
 }
 
-// SSHT[o瑗Ăt@C̃f[^XgɂȂB
-// Xg̎o ssh_scp_receive_thread XbhōsB
+// SSHT[o瑗Ăt@C̃f[^ubNɋl߂B
+// ubN̎o ssh_scp_receive_thread XbhōsB
+// pPbgƂɃmۂAgIubN͎g񂷁B
 static void ssh2_scp_add_packetlist(PTInstVar pvar, Channel_t *c, unsigned char *buf, unsigned int buflen)
 {
-	PacketList_t *p, *old;
+	ScpRcvBlock_t *p;
+	unsigned int n;
 
 	EnterCriticalSection(&g_ssh_scp_lock);
 
-	// allocate new buffer
-	p = malloc(sizeof(PacketList_t));
-	if (p == NULL)
-		goto error;
-	p->buf = buf;
-	p->buflen = buflen;
-	p->next = NULL;
+	while (buflen > 0) {
+		p = c->scp.pktlist_tail;
+		if (p == NULL || p->len == sizeof(p->buf)) {
+			// 󂫃ubN𖖔ɂȂ
+			p = c->scp.pktlist_free;
+			if (p != NULL) {
+				c->scp.pktlist_free = p->next;
+			}
+			else {
+				p = malloc(sizeof(ScpRcvBlock_t));
+				if (p == NULL)
+					goto error;
+			}
+			p->next = NULL;
+			p->len = 0;
+			p->rd = 0;
 
-	if (c->scp.pktlist_head == NULL) {
-		c->scp.pktlist_head = p;
-		c->scp.pktlist_tail = p;
-	}
-	else {
-		old = c->scp.pktlist_tail;
-		old->next = p;
-		c->scp.pktlist_tail = p;
-	}
+			if (c->scp.pktlist_head == NULL) {
+				c->scp.pktlist_head = p;
+			}
+			else {
+				c->scp.pktlist_tail->next = p;
+			}
+			c->scp.pktlist_tail = p;
+		}
+
+		n = (unsigned int)min(buflen, sizeof(p->buf) - p->len);
+		memcpy(p->buf + p->len, buf, n);
+		p->len += n;
+		buf += n;
+		buflen -= n;
 
-	// L[ɋl񂾃f[^̑TCYZB
-	c->scp.pktlist_cursize += buflen;
+		// L[ɋl񂾃f[^̑TCYZB
+		c->scp.pktlist_cursize += n;
+	}
 
 	// L[ɋl񂾃f[^̑TCY臒l𒴂ꍇA
 	// SSHT[owindows size̍XV~
@@ -8706,33 +9313,54 @@ static void ssh2_scp_add_packetlist(PTInstVar pvar, Channel_t *c, unsigned char
 
 error:;
 	LeaveCriticalSection(&g_ssh_scp_lock);
+
+	SetEvent(c->scp.pktlist_event);
 }
 
+// 擪ubN̂܂oĂȂf[^ԂB
+// Ԃ͈͂ɂ̓CXbh͏܂Ȃ̂ŁAbNOďoĂ悢B
+// o ssh2_scp_consume_packetlist() ĂԂƁB
 static void ssh2_scp_get_packetlist(PTInstVar pvar, Channel_t *c, unsigned char **buf, unsigned int *buflen)
 {
-	PacketList_t *p;
+	ScpRcvBlock_t *p;
 
 	EnterCriticalSection(&g_ssh_scp_lock);
 
-	if (c->scp.pktlist_head == NULL) {
+	p = c->scp.pktlist_head;
+	if (p == NULL || p->rd == p->len) {
 		*buf = NULL;
 		*buflen = 0;
-		goto end;
+	}
+	else {
+		*buf = (unsigned char *)p->buf + p->rd;
+		*buflen = p->len - p->rd;
 	}
 
-	p = c->scp.pktlist_head;
-	*buf = p->buf;
-	*buflen = p->buflen;
+	LeaveCriticalSection(&g_ssh_scp_lock);
+}
 
-	c->scp.pktlist_head = p->next;
+static void ssh2_scp_consume_packetlist(PTInstVar pvar, Channel_t *c, unsigned int buflen)
+{
+	ScpRcvBlock_t *p;
 
-	if (c->scp.pktlist_head == NULL)
-		c->scp.pktlist_tail = NULL;
+	EnterCriticalSection(&g_ssh_scp_lock);
 
-	free(p);
+	p = c->scp.pktlist_head;
+	p->rd += buflen;
+	if (p->rd == p->len) {
+		if (p == c->scp.pktlist_tail) {
+			// Ō̃ubN͑l߂悤ɋɂ
+			p->rd = p->len = 0;
+		}
+		else {
+			c->scp.pktlist_head = p->next;
+			p->next = c->scp.pktlist_free;
+			c->scp.pktlist_free = p;
+		}
+	}
 
 	// L[ɋl񂾃f[^̑TCYZB
-	c->scp.pktlist_cursize -= *buflen;
+	c->scp.pktlist_cursize -= buflen;
 
 	// L[ɋl񂾃f[^̑TCY臒lꍇA
 	// SSHT[owindow size̍XVĊJ
@@ -8756,14 +9384,26 @@ static void ssh2_scp_get_packetlist(PTInstVar pvar, Channel_t *c, unsigned char
 		pvar->recv.suspended ? "(suspended)" : ""
 	);
 
-end:;
 	LeaveCriticalSection(&g_ssh_scp_lock);
 }
 
 static void ssh2_scp_alloc_packetlist(PTInstVar pvar, Channel_t *c)
 {
+	ScpRcvBlock_t *p;
+	int i;
+
 	c->scp.pktlist_head = NULL;
 	c->scp.pktlist_tail = NULL;
+	c->scp.pktlist_free = NULL;
+	// t[̏臒l܂ł̃ubN͐ɊmۂĂ
+	for (i = 0; i < SCPRCV_BLOCK_PREALLOC; i++) {
+		p = malloc(sizeof(ScpRcvBlock_t));
+		if (p == NULL)
+			break;
+		p->next = c->scp.pktlist_free;
+		c->scp.pktlist_free = p;
+	}
+	c->scp.pktlist_event = CreateEvent(NULL, FALSE, FALSE, NULL);
 	InitializeCriticalSection(&g_ssh_scp_lock);
 	c->scp.pktlist_cursize = 0;
 	pvar->recv.suspended = FALSE;
@@ -8773,19 +9413,28 @@ static void ssh2_scp_alloc_packetlist(PTInstVar pvar, Channel_t *c)
 
 static void ssh2_scp_free_packetlist(PTInstVar pvar, Channel_t *c)
 {
-	PacketList_t *p, *old;
+	ScpRcvBlock_t *p, *old;
 
 	p = c->scp.pktlist_head;
 	while (p) {
 		old = p;
 		p = p->next;
-
-		free(old->buf);
+		free(old);
+	}
+	p = c->scp.pktlist_free;
+	while (p) {
+		old = p;
+		p = p->next;
 		free(old);
 	}
 
 	c->scp.pktlist_head = NULL;
 	c->scp.pktlist_tail = NULL;
+	c->scp.pktlist_free = NULL;
+	if (c->scp.pktlist_event != NULL) {
+		CloseHandle(c->scp.pktlist_event);
+		c->scp.pktlist_event = NULL;
+	}
 	DeleteCriticalSection(&g_ssh_scp_lock);
 }
 
@@ -8884,13 +9533,8 @@ static BOOL SSH2_scp_fromremote(PTInstVar pvar, Channel_t *c, unsigned char *dat
 			ssh2_channel_send_close(pvar, c);
 		}
 		else {
-			unsigned char *newdata = malloc(buflen);
-			if (newdata != NULL) {
-				memcpy(newdata, data, buflen);
-
-				// ̒ suspended  TRUE ɂȂ邱Ƃ
-				ssh2_scp_add_packetlist(pvar, c, newdata, buflen);
-			}
+			// ̒ suspended  TRUE ɂȂ邱Ƃ
+			ssh2_scp_add_packetlist(pvar, c, data, buflen);
 
 			c->scp.recv.received_size += buflen;
 
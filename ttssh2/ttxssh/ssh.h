@@ -37,6 +37,7 @@ See LICENSE.TXT for the license.
 
 #include "zlib.h"
 #include <openssl/evp.h>
+#include <openssl/hmac.h>
 
 #include "buffer.h"
 #include "config.h"
@@ -106,6 +107,10 @@ enum channel_type {
 #define CHAN_SES_WINDOW_DEFAULT (4*CHAN_SES_PACKET_DEFAULT)
 #define CHAN_TCP_PACKET_DEFAULT (32*1024)
 #define CHAN_TCP_WINDOW_DEFAULT (4*CHAN_TCP_PACKET_DEFAULT)
+// local window̎̏(ChannelWindowMax)̊l
+// T[õf[^windowɎg؂ꍇA̒l܂Ŕ{XōL
+#define CHAN_WINDOW_MAX_DEFAULT (16*1024*1024)
+#define CHAN_WINDOW_MAX_LIMIT   (1024*1024*1024)
 #if 0 // unused
 #define CHAN_X11_PACKET_DEFAULT (16*1024)
 #define CHAN_X11_WINDOW_DEFAULT (4*CHAN_X11_PACKET_DEFAULT)
@@ -309,6 +314,7 @@ struct Mac {
 	u_char          *key;
 	unsigned int    key_len;
 	int             etm;
+	HMAC_CTX        *ctx;  // ݒς݂̃ReLXgBpPbgƂɍ蒼g񂷁B
 };
 
 struct Comp {
@@ -357,6 +363,15 @@ enum scp_dir {
 	TOREMOTE, FROMREMOTE,
 };
 
+enum sftp_xfer_dir {
+	SFTP_XFER_NONE, SFTP_XFER_GET, SFTP_XFER_PUT,
+};
+
+// SSH_sftp_transfer_status() ̖߂l
+#define SFTP_XFER_STATUS_IDLE   0   // ]ĂȂ(Ō̓]͐)
+#define SFTP_XFER_STATUS_BUSY   1   // ]
+#define SFTP_XFER_STATUS_ERROR  2   // Ō̓]͎s
+
 /* The packet handler returns TRUE to keep the handler in place,
    FALSE to remove the handler. */
 typedef BOOL (* SSHPacketHandler)(PTInstVar pvar);
@@ -418,8 +433,22 @@ typedef struct {
 	int win_rows;
 
 	unsigned short tcpport;
+
+	/* ML[Bsend()  WSAEWOULDBLOCK ԂƂ̖Mf[^ێA
+	   FD_WRITE ̒ʒm󂯂Ă瑗oB */
+	char *sendq;
+	size_t sendq_size;  /* mۍς݂̃TCY */
+	size_t sendq_head;  /* Mf[^̐擪ʒu */
+	size_t sendq_tail;  /* Mf[^̖ʒu */
+	BOOL sendq_suspended;  /* 𒴂ߑM~Ă邩 */
+	BOOL rekey_suspended;  /* ɕۑf[^ɒBߑM~Ă邩 */
 } SSHState;
 
+// ML[ɂt[臒l
+// Kp SSHState.sendq
+#define SSH_SENDQ_HIGH_WATER_MARK (1 * 1024 * 1024)  // 1MB
+#define SSH_SENDQ_LOW_WATER_MARK (256 * 1024)  // 256KB
+
 #define STATUS_DONT_SEND_USER_NAME            0x01
 #define STATUS_EXPECTING_COMPRESSION_RESPONSE 0x02
 #define STATUS_DONT_SEND_CREDENTIALS          0x04
@@ -454,11 +483,14 @@ void SSH_send(PTInstVar pvar, unsigned char const *buf, unsigned int buflen);
 /* SSH_extract_payload returns number of bytes extracted */
 int SSH_extract_payload(PTInstVar pvar, unsigned char *dest, int len);
 void SSH_end(PTInstVar pvar);
+void SSH_flush_send_queue(PTInstVar pvar);
+BOOL SSH_send_queue_is_full(PTInstVar pvar);
 
 void SSH_get_server_ID_info(PTInstVar pvar, char *dest, int len);
 void SSH_get_protocol_version_info(PTInstVar pvar, char *dest, int len);
 void SSH_get_compression_info(PTInstVar pvar, char *dest, int len);
 void SSH_get_mac_info(PTInstVar pvar, char *dest, int len);
+void SSH_get_rekey_info(PTInstVar pvar, char *dest, int len);
 
 /* len must be <= SSH_MAX_SEND_PACKET_SIZE */
 void SSH_channel_send(PTInstVar pvar, int channel_num,
@@ -482,6 +514,8 @@ int SSH_scp_sending_status(void);
 int SSH_start_scp_receive(PTInstVar pvar, char *filename);
 int SSH_scp_transaction(PTInstVar pvar, const char *sendfile, const char *dstfile, enum scp_dir direction);
 int SSH_sftp_transaction(PTInstVar pvar);
+int SSH_sftp_transfer(PTInstVar pvar, enum sftp_xfer_dir dir, const char *localfile, const char *remotefile, int resume);
+int SSH_sftp_transfer_status(void);
 
 /* auxiliary SSH2 interfaces for pkt.c */
 unsigned int SSH_get_min_packet_size(PTInstVar pvar);
@@ -521,16 +555,34 @@ typedef struct bufchain {
 	struct bufchain *next;
 } bufchain_t;
 
-typedef struct PacketList {
-	char *buf;
-	unsigned int buflen;
-	struct PacketList *next;
-} PacketList_t;
+// SCPMf[^߂ubN
+// pPbgƂmallocubNɋl߂ĂAMXbh̓ubNPʂł܂Ƃ߂ăt@CɏoB
+#define SCPRCV_BLOCK_SIZE (256 * 1024)
+
+typedef struct ScpRcvBlock {
+	struct ScpRcvBlock *next;
+	unsigned int len;    // Mf[^l߂oCg
+	unsigned int rd;     // t@C֏ooCg
+	char buf[SCPRCV_BLOCK_SIZE];
+} ScpRcvBlock_t;
 
 // SCPMɂt[臒l
 // Kp scp_t.filercvsize
 #define SCPRCV_HIGH_WATER_MARK (1 * 1024 * 1024)  // 1MB
 #define SCPRCV_LOW_WATER_MARK (0)  // 0MB
+// 炩ߊmۂĂubNBz͕KvɂȂƂɊmۂB
+#define SCPRCV_BLOCK_PREALLOC (SCPRCV_HIGH_WATER_MARK / SCPRCV_BLOCK_SIZE)
+
+// SCPM1Ƀt@Cǂݏo傫ƁAǂݏoƑMs邽߂̃obt@
+#define SCPSND_BUFFER_SIZE (256 * 1024)
+#define SCPSND_BUFFER_NUM 2
+
+// SCPMpobt@
+typedef struct scp_sendbuf {
+	char *buf;
+	size_t buflen;
+	HANDLE done;    // CXbhMIVOiԂɂȂ
+} scp_sendbuf_t;
 
 typedef struct scp {
 	enum scp_dir dir;              // transfer direction
@@ -544,14 +596,19 @@ typedef struct scp {
 	HANDLE thread;
 	unsigned int thread_id;
 	PTInstVar pvar;
+	// for sending file
+	// PostMessage obt@𑗐MXbh̏IɎQƂ邱Ƃ̂ŁA`l폜ɉ
+	scp_sendbuf_t sendbuf[SCPSND_BUFFER_NUM];
 	// for receiving file
 	long long filetotalsize;
 	long long filercvsize;
 	DWORD filemtime;
 	DWORD fileatime;
-	PacketList_t *pktlist_head;
-	PacketList_t *pktlist_tail;
+	ScpRcvBlock_t *pktlist_head;
+	ScpRcvBlock_t *pktlist_tail;
+	ScpRcvBlock_t *pktlist_free;   // gIubN
 	unsigned long pktlist_cursize;
+	HANDLE pktlist_event;          // Mf[^ǉꂽʒm
 	struct {
 		uint64_t received_size;
 	} recv;
@@ -559,8 +616,38 @@ typedef struct scp {
 
 enum sftp_state {
 	SFTP_INIT, SFTP_CONNECTED, SFTP_REALPATH,
+	SFTP_XFER_OPEN, SFTP_XFER_FSTAT, SFTP_XFER_DATA, SFTP_XFER_CLOSE,
 };
 
+// ҂ READ/WRITE v
+typedef struct sftp_request {
+	unsigned int id;
+	unsigned long long offset;
+	unsigned int len;
+} sftp_request_t;
+
+// get/put ̓]
+typedef struct sftp_xfer {
+	enum sftp_xfer_dir dir;
+	int resume;
+	char localfile[MAX_PATH];
+	char remotefile[1024];
+	FILE *fp;
+	unsigned long long filepos; // fp ݈̌ʒu(get)
+	char *iobuf;                // ǂݏopobt@(put)
+	char *handle;
+	unsigned int handle_len;
+	unsigned long long offset;  // ɗvt@Cʒu
+	unsigned long long size;    // t@CTCY(get ŕsȂƂ0)
+	unsigned long long done;    // ]ς݃oCg
+	int size_known;
+	int eof;
+	int error;
+	sftp_request_t *reqs;       // ҂̗v(num_requests)
+	unsigned int inflight;
+	DWORD start_tick;
+} sftp_xfer_t;
+
 typedef struct sftp {
 	enum sftp_state state;
 	HWND console_window;
@@ -576,6 +663,11 @@ typedef struct sftp {
 	unsigned long long limit_kbps;
 	//struct bwlimit bwlimit_in, bwlimit_out;
 	char path[1024];
+	// `lf[^̐؂ڂSFTPbZ[W̐؂ڂ͈vȂ̂ŁAőgݗĂ
+	unsigned char *rbuf;
+	unsigned int rbuf_len;
+	unsigned int rbuf_size;
+	sftp_xfer_t xfer;
 } sftp_t;
 
 typedef struct channel {
@@ -588,6 +680,7 @@ typedef struct channel {
 	unsigned int local_maxpacket;
 	unsigned int remote_window;
 	unsigned int remote_maxpacket;
+	DWORD window_tick;  // CHANNEL_OPEN ܂͍Ō WINDOW_ADJUST 𑗂
 	enum channel_type type;
 	int local_num;
 	bufchain_t *bufchain;
@@ -598,6 +691,7 @@ typedef struct channel {
 	int agent_request_len;
 	sftp_t sftp;
 #define SSH_CHANNEL_STATE_CLOSE_SENT 0x00000001
+#define SSH_CHANNEL_STATE_EOF_PENDING 0x00000002
 	unsigned int state;
 } Channel_t;
 
@@ -155,6 +155,8 @@ static void init_TTSSH(PTInstVar pvar)
 	pvar->hostdlg_activated = FALSE;
 	pvar->socket = INVALID_SOCKET;
 	pvar->NotificationWindow = NULL;
+	pvar->sock_notify_wnd = NULL;
+	pvar->old_sock_notify_wnd_proc = NULL;
 	pvar->protocol_major = 0;
 	pvar->protocol_minor = 0;
 
@@ -195,6 +197,11 @@ static void uninit_TTSSH(PTInstVar pvar)
 	FWD_end(pvar);
 	FWDUI_end(pvar);
 
+	if (pvar->sock_notify_wnd != NULL) {
+		DestroyWindow(pvar->sock_notify_wnd);
+		pvar->sock_notify_wnd = NULL;
+	}
+
 	// VT EBhẼACR
 	SetVTIconID(pvar->cv, NULL, 0);
 
@@ -418,6 +425,38 @@ static void read_ssh_options(PTInstVar pvar, const wchar_t *fileName)
 
 	settings->AuthBanner = GetPrivateProfileInt("TTSSH", "AuthBanner", 3, fileName);
 
+	// local window̎̏
+	settings->ChannelWindowMax = GetPrivateProfileInt("TTSSH", "ChannelWindowMax", CHAN_WINDOW_MAX_DEFAULT, fileName);
+	if (settings->ChannelWindowMax < 0 || settings->ChannelWindowMax > CHAN_WINDOW_MAX_LIMIT) {
+		settings->ChannelWindowMax = CHAN_WINDOW_MAX_DEFAULT;
+	}
+
+	// ̍Č
+	settings->RekeyLimit = GetPrivateProfileInt("TTSSH", "RekeyLimit", 0, fileName);
+	if (settings->RekeyLimit < 0) {
+		settings->RekeyLimit = 0;
+	}
+	settings->RekeyInterval = GetPrivateProfileInt("TTSSH", "RekeyInterval", 0, fileName);
+	if (settings->RekeyInterval < 0) {
+		settings->RekeyInterval = 0;
+	}
+
+	// pPbgk̈k헪
+	settings->CompressionStrategy = GetPrivateProfileInt("TTSSH", "CompressionStrategy", Z_DEFAULT_STRATEGY, fileName);
+	if (settings->CompressionStrategy < Z_DEFAULT_STRATEGY || settings->CompressionStrategy > Z_FIXED) {
+		settings->CompressionStrategy = Z_DEFAULT_STRATEGY;
+	}
+
+	// SFTP]̗vTCYƓv
+	settings->SftpBufferSize = GetPrivateProfileInt("TTSSH", "SftpBufferSize", DEFAULT_COPY_BUFLEN, fileName);
+	if (settings->SftpBufferSize < 1024 || settings->SftpBufferSize > SFTP_MAX_MSG_LENGTH - 1024) {
+		settings->SftpBufferSize = DEFAULT_COPY_BUFLEN;
+	}
+	settings->SftpRequests = GetPrivateProfileInt("TTSSH", "SftpRequests", DEFAULT_NUM_REQUESTS, fileName);
+	if (settings->SftpRequests < 1 || settings->SftpRequests > MAX_NUM_REQUESTS) {
+		settings->SftpRequests = DEFAULT_NUM_REQUESTS;
+	}
+
 #ifdef _DEBUG
 	GetPrivateProfileStringW(L"TTSSH", L"KexKeyLogFile", L"", settings->KexKeyLogFile, _countof(settings->KexKeyLogFile), fileName);
 	if (settings->KexKeyLogFile[0] == 0) {
@@ -566,6 +605,24 @@ static void write_ssh_options(PTInstVar pvar, const wchar_t *fileName,
 	_itoa_s(settings->AuthBanner, buf, sizeof(buf), 10);
 	WritePrivateProfileString("TTSSH", "AuthBanner", buf, fileName);
 
+	_itoa_s(settings->ChannelWindowMax, buf, sizeof(buf), 10);
+	WritePrivateProfileString("TTSSH", "ChannelWindowMax", buf, fileName);
+
+	_itoa_s(settings->RekeyLimit, buf, sizeof(buf), 10);
+	WritePrivateProfileString("TTSSH", "RekeyLimit", buf, fileName);
+
+	_itoa_s(settings->RekeyInterval, buf, sizeof(buf), 10);
+	WritePrivateProfileString("TTSSH", "RekeyInterval", buf, fileName);
+
+	_itoa_s(settings->CompressionStrategy, buf, sizeof(buf), 10);
+	WritePrivateProfileString("TTSSH", "CompressionStrategy", buf, fileName);
+
+	_itoa_s(settings->SftpBufferSize, buf, sizeof(buf), 10);
+	WritePrivateProfileString("TTSSH", "SftpBufferSize", buf, fileName);
+
+	_itoa_s(settings->SftpRequests, buf, sizeof(buf), 10);
+	WritePrivateProfileString("TTSSH", "SftpRequests", buf, fileName);
+
 #ifdef _DEBUG
 	WritePrivateProfileStringW(L"TTSSH", L"KexKeyLogFile", settings->KexKeyLogFile, fileName);
 	WritePrivateProfileString("TTSSH", "KexKeyLogging",
@@ -677,10 +734,63 @@ static int PASCAL TTXconnect(SOCKET s,
 	return (pvar->Pconnect) (s, name, namelen);
 }
 
+// SSH\Pbg̒ʒm𒆌pBEBhE
+//
+// pPbg̓mubLOőMA؂Ȃ͑ML[ɐςށB
+// L[̑𑗂ɂ FD_WRITE ̒ʒmKvATera Term {̂ FD_WRITE 
+// Ȃ߁A\Pbg̒ʒm񂱂̃EBhEŎ󂯎AFD_WRITE 
+// ŏāAȊO Tera Term w肵EBhEւ̂܂ܓ]B
+#define WM_SSH_SOCK_NOTIFY (WM_APP+9996)
+
+static LRESULT CALLBACK sock_notify_wnd_proc(HWND wnd, UINT msg, WPARAM wParam,
+                                             LPARAM lParam)
+{
+	if (msg == WM_SSH_SOCK_NOTIFY) {
+		if ((SOCKET)wParam != pvar->socket) {
+			// \Pbg̒ʒmcĂ
+			return TRUE;
+		}
+		if (WSAGETSELECTEVENT(lParam) == FD_WRITE) {
+			if (WSAGETSELECTERROR(lParam) == 0) {
+				ssh_heartbeat_lock();
+				SSH_flush_send_queue(pvar);
+				ssh_heartbeat_unlock();
+			}
+			if ((pvar->notification_events & FD_WRITE) == 0) {
+				return TRUE;
+			}
+		}
+		PostMessage(pvar->NotificationWindow, pvar->notification_msg, wParam, lParam);
+		return TRUE;
+	}
+
+	return CallWindowProc(pvar->old_sock_notify_wnd_proc, wnd, msg, wParam, lParam);
+}
+
+static HWND make_sock_notify_wnd(PTInstVar pvar)
+{
+	if (pvar->sock_notify_wnd == NULL) {
+		pvar->sock_notify_wnd =
+			CreateWindow("STATIC", "TTSSH Socket Notification",
+			             WS_DISABLED | WS_POPUP, 0, 0, 1, 1, NULL, NULL,
+			             hInst, NULL);
+		if (pvar->sock_notify_wnd != NULL) {
+			pvar->old_sock_notify_wnd_proc =
+				(WNDPROC) SetWindowLongPtr(pvar->sock_notify_wnd,
+				                           GWLP_WNDPROC,
+				                           (LONG_PTR) sock_notify_wnd_proc);
+		}
+	}
+
+	return pvar->sock_notify_wnd;
+}
+
 static int PASCAL TTXWSAAsyncSelect(SOCKET s, HWND hWnd, u_int wMsg,
                                         long lEvent)
 {
 	if (s == pvar->socket) {
+		HWND wnd;
+
 		pvar->notification_events = lEvent;
 		pvar->notification_msg = wMsg;
 
@@ -692,6 +802,11 @@ static int PASCAL TTXWSAAsyncSelect(SOCKET s, HWND hWnd, u_int wMsg,
 			// łȂꍇAłɐؒfԂɂւ炸AF؃_CAO
 			// \ꂽ܂܂ƂȂĂB
 		}
+
+		// ʒmꍇȊÓABEBhEoR FD_WRITE 󂯎
+		if (lEvent != 0 && (wnd = make_sock_notify_wnd(pvar)) != NULL) {
+			return (pvar->PWSAAsyncSelect) (s, wnd, WM_SSH_SOCK_NOTIFY, lEvent | FD_WRITE);
+		}
 	}
 
 	return (pvar->PWSAAsyncSelect) (s, hWnd, wMsg, lEvent);
@@ -717,6 +832,11 @@ static int PASCAL TTXsend(SOCKET s, char const *buf, int len,
 {
 	if (s == pvar->socket) {
 		ssh_heartbeat_lock();
+		if (SSH_send_queue_is_full(pvar)) {
+			// ML[󂭂܂ŁAf[^ Tera Term ɎcĂĂ炤
+			ssh_heartbeat_unlock();
+			return 0;
+		}
 		SSH_send(pvar, buf, len);
 		ssh_heartbeat_unlock();
 		return len;
@@ -2091,6 +2211,13 @@ static void about_dlg_set_abouttext(PTInstVar pvar, HWND dlg, digest_algorithm d
 			strncat_s(buf2, sizeof(buf2), buf, _TRUNCATE);
 			strncat_s(buf2, sizeof(buf2), "\r\n", _TRUNCATE);
 
+			UTIL_get_lang_msgU8("DLG_ABOUT_REKEY", pvar, "Rekey:");
+			strncat_s(buf2, sizeof(buf2), pvar->UIMsg, _TRUNCATE);
+			strncat_s(buf2, sizeof(buf2), " ", _TRUNCATE);
+			SSH_get_rekey_info(pvar, buf, sizeof(buf));
+			strncat_s(buf2, sizeof(buf2), buf, _TRUNCATE);
+			strncat_s(buf2, sizeof(buf2), "\r\n", _TRUNCATE);
+
 			UTIL_get_lang_msgU8("DLG_ABOUT_AUTH", pvar, "Authentication:");
 			strncat_s(buf2, sizeof(buf2), pvar->UIMsg, _TRUNCATE);
 			strncat_s(buf2, sizeof(buf2), " ", _TRUNCATE);
@@ -3629,6 +3756,22 @@ __declspec(dllexport) int CALLBACK TTXScpReceivefile(char *remotefile, char *loc
 	return SSH_scp_transaction(pvar, remotefile, localfile, FROMREMOTE);
 }
 
+// }NR}h"sftpsend"/"sftprecv"Ăяo߂ɁADLLOփGNX|[gB"ttxssh.def"t@CɋLځB
+__declspec(dllexport) int CALLBACK TTXSftpSendfile(char *localfile, char *remotefile, int resume)
+{
+	return SSH_sftp_transfer(pvar, SFTP_XFER_PUT, localfile, remotefile, resume);
+}
+
+__declspec(dllexport) int CALLBACK TTXSftpReceivefile(char *remotefile, char *localfile, int resume)
+{
+	return SSH_sftp_transfer(pvar, SFTP_XFER_GET, localfile, remotefile, resume);
+}
+
+__declspec(dllexport) int CALLBACK TTXSftpTransferStatus(void)
+{
+	return SSH_sftp_transfer_status();
+}
+
 
 /**
  * TTSSH̐ݒe(known hosts file)ԂB
@@ -3733,10 +3876,10 @@ static void save_bcrypt_private_key(char *passphrase, char *filename, char *comm
 	unsigned int len, check;
 	FILE *fp;
 
-	b = buffer_init();
-	kdf = buffer_init();
-	encoded = buffer_init();
-	blob = buffer_init();
+	b = buffer_init_secret();
+	kdf = buffer_init_secret();
+	encoded = buffer_init_secret();
+	blob = buffer_init_secret();
 	if (b == NULL || kdf == NULL || encoded == NULL || blob == NULL)
 		goto ed25519_error;
 
@@ -4299,7 +4442,7 @@ static INT_PTR CALLBACK TTXKeyGenerator(HWND dlg, UINT msg, WPARAM wParam,
 				BIGNUM *e, *n;
 				BIGNUM *p, *q, *g, *pub_key;
 
-				b = buffer_init();
+				b = buffer_init_secret();
 				if (b == NULL)
 					goto public_error;
 
@@ -4514,10 +4657,10 @@ public_error:
 					cipher_num = SSH_CIPHER_3DES; // 3DES
 				}
 
-				b = buffer_init();
+				b = buffer_init_secret();
 				if (b == NULL)
 					break;
-				enc = buffer_init();
+				enc = buffer_init_secret();
 				if (enc == NULL) {
 					buffer_free(b);
 					break;
@@ -5096,6 +5239,7 @@ BOOL WINAPI DllMain(HANDLE hInstance,
 #endif
 		setlocale(LC_ALL, "");
 		DisableThreadLibraryCalls(hInstance);
+		buffer_pool_init();
 		hInst = hInstance;
 		pvar = &InstVar;
 		__mem_mapping =
@@ -5132,6 +5276,7 @@ BOOL WINAPI DllMain(HANDLE hInstance,
 			UnmapViewOfFile(__mem_mapping);
 			CloseHandle(__mem_mapping);
 		}
+		buffer_pool_end();
 		break;
 	}
 	return TRUE;
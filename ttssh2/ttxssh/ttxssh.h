@@ -217,6 +217,20 @@ typedef struct _TS_SSH {
 	//   for publickey authentication (not for server hostkey)
 	//   for RSA key only
 	char RSAPubkeySignAlgorithmOrder[RSA_PUBKEY_SIGN_ALGO_MAX+1];
+
+	// local window̎̏ (0 = Ȃ)
+	int ChannelWindowMax;
+
+	// ̍Čn߂鑗M(MB, 0 = Íɉl)ƌoߎ(b, 0 = Ȃ)
+	int RekeyLimit;
+	int RekeyInterval;
+
+	// pPbgk zlib ̈k헪 (Z_DEFAULT_STRATEGY, Z_FILTERED, ... ̒l)
+	int CompressionStrategy;
+
+	// SFTP]1ṽoCgƁA҂ɑv̐
+	int SftpBufferSize;
+	int SftpRequests;
 } TS_SSH;
 
 typedef struct _TInstVar {
@@ -247,6 +261,8 @@ typedef struct _TInstVar {
 	HWND NotificationWindow;
 	unsigned int notification_msg;
 	long notification_events;
+	HWND sock_notify_wnd;  // FD_WRITE 󂯎邽߂̉BEBhE
+	WNDPROC old_sock_notify_wnd_proc;
 	HICON OldSmallIcon; // gpȂ
 	HICON OldLargeIcon; // gpȂ
 
@@ -319,10 +335,18 @@ typedef struct _TInstVar {
 	int keyboard_interactive_password_input;
 	int userauth_retry_count;
 	buffer_t *decomp_buffer;
+	buffer_t *comp_buffer;
 	buffer_t *authbanner_buffer;
 	char *ssh2_authlist;
 	BOOL tryed_ssh2_authlist;
 	HWND ssh_hearbeat_dialog;
+	DWORD ssh2_rtt;  // CHANNEL_OPEN  CONFIRMATION ܂ł̉(ms)̍ŏl
+	unsigned long long ssh2_rekey_bytes[MODE_MAX];  // Ǒ̑M
+	time_t ssh2_rekey_time;  // Ǒ̊
+	DWORD ssh2_rekey_start_tick;  // ̍Čn߂
+	int ssh2_rekey_count;  // ̍Č̉
+	DWORD ssh2_rekey_stall_last;  // ߂̌̍Čœ]~܂Ă(ms)
+	DWORD ssh2_rekey_stall_max;  // ̍Čœ]~܂Ă(ms)̍ől
 
 	/* Pageant Ƃ̒ʐMp */
 	unsigned char *pageant_key;